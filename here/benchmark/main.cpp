@@ -0,0 +1,270 @@
+// Headless ParticleWorld benchmark. Runs fixed-seed scenarios without opening
+// a window and writes one <scenario>.csv per scenario into the working directory.
+
+// Run every scenario with 1 to N threads:      ./bench -t=8
+// Run scenario 2 with 4 threads, 10 repeats:   ./bench -b=2 -w=4 -r=10
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Constants.hpp"
+#include "Particle.hpp"
+#include "ParticleWorld.hpp"
+#include "Random.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace SandSim;
+
+namespace
+{
+    struct Scenario
+    {
+        const char *name;
+        void (*create)(ParticleWorld &world);
+        int stepCount;
+    };
+
+    struct RunResult
+    {
+        double totalMs;
+        double meanMs;
+        double p99Ms;
+        double cellsPerSecond;
+    };
+
+    // Half-open [x0, x1) x [y0, y1)
+    void fillRect(ParticleWorld &world, int x0, int y0, int x1, int y1, MaterialID material)
+    {
+        world.fillRect(x0, y0, x1 - 1, y1 - 1, material);
+    }
+
+    // Tall sand block collapsing over a stone step
+    void createSandAvalanche(ParticleWorld &world)
+    {
+        int w = world.getWidth();
+        int h = world.getHeight();
+        fillRect(world, 0, h - 10, w, h, MaterialID::Stone);
+        fillRect(world, 0, h / 2, w / 3, h - 10, MaterialID::Stone);
+        fillRect(world, 0, 0, w / 3, h / 2, MaterialID::Sand);
+    }
+
+    // Full-height water column levelling out across the floor
+    void createWaterTank(ParticleWorld &world)
+    {
+        fillRect(world, 0, 0, world.getWidth() / 3, world.getHeight(), MaterialID::Water);
+    }
+
+    // Wood trunks under a shared canopy, lit at several points along the top
+    void createForestFire(ParticleWorld &world)
+    {
+        int w = world.getWidth();
+        int h = world.getHeight();
+        for (int x = 4; x < w; x += 6)
+        {
+            fillRect(world, x, h / 2, x + 3, h, MaterialID::Wood);
+        }
+        fillRect(world, 0, h / 2 - 4, w, h / 2, MaterialID::Wood);
+        for (int x = 0; x < w; x += 48)
+        {
+            fillRect(world, x, h / 2 - 10, x + 6, h / 2 - 4, MaterialID::Fire);
+        }
+    }
+
+    // Gunpowder bed on stone, ignited at one end
+    void createGunpowderChain(ParticleWorld &world)
+    {
+        int w = world.getWidth();
+        int h = world.getHeight();
+        fillRect(world, 0, h - 8, w, h, MaterialID::Stone);
+        fillRect(world, 0, h - 20, w, h - 8, MaterialID::Gunpowder);
+        fillRect(world, 0, h - 26, 6, h - 20, MaterialID::Fire);
+    }
+
+    // Lava poured into a water pool
+    void createLavaWater(ParticleWorld &world)
+    {
+        int w = world.getWidth();
+        int h = world.getHeight();
+        fillRect(world, 0, h - h / 4, w, h, MaterialID::Water);
+        fillRect(world, w / 3, 0, 2 * w / 3, h / 4, MaterialID::Lava);
+    }
+
+    double peakMemoryMB()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+        return 0.0;
+#else
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+        return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+    }
+
+    RunResult runScenario(const Scenario &scenario, unsigned int threadCount, std::vector<double> &frameMs)
+    {
+        const float timeStep = 1.0f / DEFAULT_TICK_RATE;
+
+        Random::setSeed(42);
+        ParticleWorld world(TEXTURE_WIDTH, TEXTURE_HEIGHT);
+        world.setWorkerCount(threadCount);
+        scenario.create(world);
+
+        // First step activates every chunk the setup touched; keep it out of the timings
+        world.update(timeStep);
+        std::uint64_t startCells = world.getUpdatedCellCount();
+
+        frameMs.clear();
+        auto start = std::chrono::steady_clock::now();
+        for (int step = 1; step < scenario.stepCount; ++step)
+        {
+            auto frameStart = std::chrono::steady_clock::now();
+            world.update(timeStep);
+            frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        }
+        double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        RunResult result;
+        result.totalMs = totalMs;
+        result.meanMs = totalMs / frameMs.size();
+        std::sort(frameMs.begin(), frameMs.end());
+        result.p99Ms = frameMs[std::min(frameMs.size() - 1, frameMs.size() * 99 / 100)];
+        result.cellsPerSecond = (world.getUpdatedCellCount() - startCells) / (totalMs / 1000.0);
+        return result;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const Scenario scenarios[] = {
+        {"sand_avalanche", createSandAvalanche, 600},
+        {"water_tank", createWaterTank, 600},
+        {"forest_fire", createForestFire, 900},
+        {"gunpowder_chain", createGunpowderChain, 600},
+        {"lava_water", createLavaWater, 600},
+    };
+    const int scenarioCount = static_cast<int>(sizeof(scenarios) / sizeof(scenarios[0]));
+
+    int maxThreadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int runCount = 4;
+    int singleScenario = -1;
+    int singleWorkerCount = -1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        if (std::strncmp(arg, "-t=", 3) == 0)
+        {
+            maxThreadCount = std::clamp(std::atoi(arg + 3), 1, maxThreadCount);
+        }
+        else if (std::strncmp(arg, "-b=", 3) == 0)
+        {
+            singleScenario = std::clamp(std::atoi(arg + 3), 0, scenarioCount - 1);
+        }
+        else if (std::strncmp(arg, "-w=", 3) == 0)
+        {
+            singleWorkerCount = std::atoi(arg + 3);
+        }
+        else if (std::strncmp(arg, "-r=", 3) == 0)
+        {
+            runCount = std::clamp(std::atoi(arg + 3), 1, 1000);
+        }
+        else if (std::strcmp(arg, "-h") == 0)
+        {
+            std::printf("Usage\n"
+                        "-t=<integer>: the maximum number of threads to use\n"
+                        "-b=<integer>: run a single scenario\n"
+                        "-w=<integer>: run a single worker count\n"
+                        "-r=<integer>: number of repeats (default is 4)\n");
+            return 0;
+        }
+    }
+
+    if (singleWorkerCount != -1)
+    {
+        singleWorkerCount = std::clamp(singleWorkerCount, 1, maxThreadCount);
+    }
+
+    std::printf("Starting ParticleWorld benchmarks (%ux%u)\n", TEXTURE_WIDTH, TEXTURE_HEIGHT);
+    std::printf("======================================\n");
+
+    std::vector<double> frameMs;
+
+    for (int scenarioIndex = 0; scenarioIndex < scenarioCount; ++scenarioIndex)
+    {
+        if (singleScenario != -1 && scenarioIndex != singleScenario)
+            continue;
+
+        const Scenario &scenario = scenarios[scenarioIndex];
+        std::printf("scenario: %s, steps = %d\n", scenario.name, scenario.stepCount);
+
+        // Best run per thread count, the same way 2dbox/benchmark reports
+        std::vector<RunResult> best(maxThreadCount);
+        std::vector<bool> ran(maxThreadCount, false);
+
+        for (int threadCount = 1; threadCount <= maxThreadCount; ++threadCount)
+        {
+            if (singleWorkerCount != -1 && singleWorkerCount != threadCount)
+                continue;
+
+            std::printf("thread count: %d\n", threadCount);
+
+            for (int runIndex = 0; runIndex < runCount; ++runIndex)
+            {
+                RunResult result = runScenario(scenario, static_cast<unsigned int>(threadCount), frameMs);
+                std::printf("run %d : %g (ms), mean %.3f, p99 %.3f, %.3g cells/s\n",
+                            runIndex, result.totalMs, result.meanMs, result.p99Ms, result.cellsPerSecond);
+
+                RunResult &slot = best[threadCount - 1];
+                if (!ran[threadCount - 1] || result.totalMs < slot.totalMs)
+                    slot = result;
+                ran[threadCount - 1] = true;
+            }
+        }
+
+        std::printf("\n");
+
+        std::string fileName = std::string(scenario.name) + ".csv";
+        FILE *file = std::fopen(fileName.c_str(), "w");
+        if (file == nullptr)
+            continue;
+
+        std::fprintf(file, "threads,ms,mean_ms,p99_ms,cells_per_s\n");
+        for (int threadIndex = 1; threadIndex <= maxThreadCount; ++threadIndex)
+        {
+            if (!ran[threadIndex - 1])
+                continue;
+            const RunResult &r = best[threadIndex - 1];
+            std::fprintf(file, "%d,%g,%g,%g,%g\n", threadIndex, r.totalMs, r.meanMs, r.p99Ms, r.cellsPerSecond);
+        }
+
+        std::fclose(file);
+    }
+
+    // The OS only tracks the peak for the whole process, so it covers every
+    // scenario that ran rather than any one of them
+    std::printf("peak memory (all scenarios): %.1f MB\n", peakMemoryMB());
+    std::printf("======================================\n");
+    std::printf("All ParticleWorld benchmarks complete!\n");
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <climits>
+
+namespace SandSim {
+    // Inclusive rectangle of cells (in world coordinates) that need simulating
+    struct DirtyRect {
+        int minX = INT_MAX;
+        int minY = INT_MAX;
+        int maxX = INT_MIN;
+        int maxY = INT_MIN;
+
+        bool isEmpty() const { return minX > maxX || minY > maxY; }
+        bool containsRow(int y) const { return y >= minY && y <= maxY; }
+
+        void reset() {
+            minX = minY = INT_MAX;
+            maxX = maxY = INT_MIN;
+        }
+
+        void expand(int x0, int y0, int x1, int y1) {
+            minX = std::min(minX, x0);
+            minY = std::min(minY, y0);
+            maxX = std::max(maxX, x1);
+            maxY = std::max(maxY, y1);
+        }
+    };
+
+    // Dirty rect that several workers may grow at once (neighbouring chunks
+    // write into each other's margins during a parallel phase)
+    struct AtomicDirtyRect {
+        std::atomic<int> minX{INT_MAX};
+        std::atomic<int> minY{INT_MAX};
+        std::atomic<int> maxX{INT_MIN};
+        std::atomic<int> maxY{INT_MIN};
+
+        void reset() {
+            minX.store(INT_MAX, std::memory_order_relaxed);
+            minY.store(INT_MAX, std::memory_order_relaxed);
+            maxX.store(INT_MIN, std::memory_order_relaxed);
+            maxY.store(INT_MIN, std::memory_order_relaxed);
+        }
+
+        void expand(int x0, int y0, int x1, int y1) {
+            lower(minX, x0);
+            lower(minY, y0);
+            raise(maxX, x1);
+            raise(maxY, y1);
+        }
+
+        DirtyRect load() const {
+            DirtyRect rect;
+            rect.minX = minX.load(std::memory_order_relaxed);
+            rect.minY = minY.load(std::memory_order_relaxed);
+            rect.maxX = maxX.load(std::memory_order_relaxed);
+            rect.maxY = maxY.load(std::memory_order_relaxed);
+            return rect;
+        }
+
+    private:
+        // Most writes land inside the rect already, so only CAS when it grows
+        static void lower(std::atomic<int>& bound, int value) {
+            int current = bound.load(std::memory_order_relaxed);
+            while (value < current && !bound.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+
+        static void raise(std::atomic<int>& bound, int value) {
+            int current = bound.load(std::memory_order_relaxed);
+            while (value > current && !bound.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+    };
+
+    // Fixed-size block of the world. Writes during a frame grow `next`, which
+    // becomes `current` at the start of the following update; a chunk whose
+    // current rect is empty is skipped entirely. `pixels` separately collects
+    // the cells whose colour changed since the renderer last uploaded them.
+    struct Chunk {
+        int originX = 0;
+        int originY = 0;
+        DirtyRect current;
+        AtomicDirtyRect next;
+        AtomicDirtyRect pixels;
+
+        bool isActive() const { return !current.isEmpty(); }
+
+        void beginFrame() {
+            current = next.load();
+            next.reset();
+        }
+
+        void reset() {
+            current.reset();
+            next.reset();
+        }
+    };
+}
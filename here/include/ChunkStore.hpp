@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include "WorldFile.hpp"
+
+namespace SandSim {
+    // A resident chunk copied out of the window, to be written back later
+    struct ChunkPage {
+        int cx = 0;
+        int cy = 0;
+        WorldSnapshot cells;
+    };
+
+    // On-disk page store for maps larger than the resident window. Each chunk
+    // is a CHUNK_SIZE x CHUNK_SIZE v2 world file named by its map coordinates;
+    // chunks that were never written, or were written empty, have no file and
+    // read back as empty, so untouched parts of a map cost nothing.
+    // Reads and writes may come from several threads.
+    class ChunkStore {
+    public:
+        // Opens the store in directory, creating it with the given size in
+        // chunks if it does not exist yet. An existing store keeps its size.
+        bool open(const std::string& directory, int chunksX, int chunksY);
+
+        int getChunksX() const { return chunksX; }
+        int getChunksY() const { return chunksY; }
+        const std::string& getDirectory() const { return directory; }
+
+        // False if the chunk has no page, in which case it is empty
+        bool read(int cx, int cy, WorldSnapshot& chunk) const;
+        bool write(int cx, int cy, const WorldSnapshot& chunk);
+
+        // Pages copied now but written later take a version here, and are
+        // skipped when written if the chunk was stored again since the copy
+        std::uint64_t reserveVersion();
+        bool write(int cx, int cy, const WorldSnapshot& chunk, std::uint64_t version);
+
+    private:
+        std::string directory;
+        int chunksX = 0;
+        int chunksY = 0;
+
+        mutable std::mutex mutex;
+        std::uint64_t nextVersion = 1;
+        std::map<std::pair<int, int>, std::uint64_t> writtenVersions;
+
+        std::string chunkPath(int cx, int cy) const;
+    };
+}
@@ -1,4 +1,7 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <SFML/Graphics/Color.hpp>
 
 namespace SandSim {
     // Window settings
@@ -13,6 +16,42 @@ namespace SandSim {
     constexpr float MIN_SELECTION_RADIUS = 1.0f;
     constexpr float MAX_SELECTION_RADIUS = 100.0f;
     
+    // Coarse temperature field: one value per HEAT_CELL_SIZE square of cells.
+    // Each tick it moves HEAT_DIFFUSION of the way to its 4-neighbour mean and
+    // keeps HEAT_RETAIN of the result; the rest is lost to the air.
+    constexpr int HEAT_CELL_SIZE = 4;
+    constexpr float HEAT_DIFFUSION = 0.2f;
+    constexpr float HEAT_RETAIN = 0.9f;
+    // Phase changes, rolled 1 in N per tick once past their threshold. Each
+    // flammable material has its own ignition odds.
+    constexpr float IGNITION_TEMP = 200.0f;
+    constexpr float BOIL_TEMP = 100.0f;       // water turns to steam...
+    constexpr int BOIL_ODDS = 100;
+    constexpr float BOIL_HEAT = 15.0f;        // ...taking this much heat with it
+    constexpr float LAVA_SOLIDIFY_TEMP = 20.0f;  // lava below this sets into stone
+    constexpr int LAVA_SOLIDIFY_ODDS = 60;
+    
+    // Simulation chunks (dirty-rect tracking granularity)
+    constexpr int CHUNK_SIZE = 32;
+    // Furthest a material update may read or write from its own cell; keeps
+    // same-colour chunks of the parallel checkerboard from overlapping
+    constexpr int CHUNK_MARGIN = CHUNK_SIZE / 2 - 1;
+    // Every heat cell lies in one chunk, so parallel workers never share one
+    static_assert(CHUNK_SIZE % HEAT_CELL_SIZE == 0, "heat cells must tile chunks");
+    // Updates in a row in which a cell neither moved nor asked to stay awake
+    // before it stops being dispatched
+    constexpr std::uint8_t SLEEP_FRAMES = 3;
+    
+    // Streamed maps (--map): size of a new map and resident window budget, in chunks
+    constexpr int DEFAULT_MAP_CHUNKS = 128;
+    constexpr int DEFAULT_RESIDENT_CHUNK_BUDGET = 768;
+    constexpr int CAMERA_PAN_SPEED = 8;  // cells per frame while an arrow key is held
+    
+    // Fixed simulation timestep (--tick-rate): updates per second, and the most
+    // ticks run in one frame to catch up after a stall
+    constexpr int DEFAULT_TICK_RATE = 60;
+    constexpr int MAX_CATCH_UP_TICKS = 4;
+    
     // Material IDs
     enum class MaterialID : uint8_t {
         Empty = 0,
@@ -30,6 +69,7 @@ namespace SandSim {
         Stone = 12,
         Acid = 13
     };
+    constexpr std::size_t MATERIAL_COUNT = 14;
     
     // Material colors
     constexpr sf::Color MAT_COL_EMPTY(0, 0, 0, 0);
@@ -0,0 +1,38 @@
+#pragma once
+#include "Constants.hpp"
+
+namespace SandSim {
+    // Turns real elapsed time into a whole number of fixed simulation ticks.
+    // Leftover time carries over to the next call; after a stall at most
+    // maxCatchUpTicks run and the rest of the backlog is dropped, so the world
+    // slows down briefly instead of jumping ahead.
+    class FixedTimestep {
+    public:
+        explicit FixedTimestep(int tickRate = DEFAULT_TICK_RATE, int maxCatchUpTicks = MAX_CATCH_UP_TICKS)
+            : step(1.0f / tickRate), maxCatchUpTicks(maxCatchUpTicks), accumulator(0.0f) {}
+
+        // Ticks to run for elapsedSeconds of real time
+        int advance(float elapsedSeconds) {
+            accumulator += elapsedSeconds;
+            int ticks = static_cast<int>(accumulator / step);
+            if (ticks > maxCatchUpTicks) {
+                ticks = maxCatchUpTicks;
+                accumulator = 0.0f;
+            } else {
+                accumulator -= ticks * step;
+            }
+            return ticks;
+        }
+
+        // Real time until the next tick is due
+        float untilNextTick() const { return step - accumulator; }
+
+        float getStep() const { return step; }
+        void reset() { accumulator = 0.0f; }
+
+    private:
+        float step;
+        int maxCatchUpTicks;
+        float accumulator;
+    };
+}
@@ -4,6 +4,7 @@
 #include <string>
 #include <memory>
 #include "Constants.hpp"
+#include "ThumbnailCache.hpp"
 
 namespace SandSim {
     struct LevelInfo {
@@ -26,6 +27,7 @@ namespace SandSim {
     class LevelMenu {
     private:
         std::vector<LevelInfo> levels;
+        ThumbnailCache thumbnailCache;
         sf::RenderTexture menuTexture;
         sf::Sprite menuSprite;
         sf::Font fonttt;
@@ -87,7 +89,7 @@ void refreshLevels();
         sf::Vector2f windowToMenuCoords(const sf::Vector2f& windowPos, const sf::RenderWindow& window) const;
         
     private:
-        void generateThumbnail(const std::string& worldFile, sf::Texture& thumbnail);
+        void loadThumbnail(const std::string& worldFile, sf::Texture& thumbnail);
         void calculateLayout();
         void setupLayout();
         void updateScrollBounds();
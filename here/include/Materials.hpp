@@ -0,0 +1,133 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <SFML/Graphics/Color.hpp>
+#include "Constants.hpp"
+
+namespace SandSim {
+    // Which movement kernel a material uses
+    enum class MaterialState : std::uint8_t {
+        Empty,
+        Static,
+        Powder,
+        Liquid,
+        Gas
+    };
+
+    // Tuning for the state's movement kernel; fields a kernel doesn't use are 0
+    struct MotionParams {
+        float gravityScale;  // fraction of GRAVITY added to velocity.y each second
+        float maxSpeed;      // clamp on |velocity.y|
+        float friction;      // velocity.x multiplier per frame while moving
+        float sideImpulse;   // velocity.x kick when sliding off a diagonal
+        float maxSideSpeed;  // clamp on |velocity.x| after that kick
+        float jitter;        // random velocity.x noise (flow for liquids, drift for gases)
+        float dampingY;      // velocity multipliers when fully blocked
+        float dampingX;
+    };
+
+    // How a cell's variation byte maps to its colour
+    enum class ColorMode : std::uint8_t {
+        Jitter,     // base colour offset per channel by a hash of the variation
+        Palette,    // variation indexes the material's palette
+        Fade,       // every channel scaled by variation / 255
+        FadeAlpha   // alpha scaled by variation / 255
+    };
+
+    struct MaterialProps {
+        const char* name;
+        MaterialState state;
+        float density;             // movers sink through liquids lighter than themselves
+        int viscosity;             // liquids: 1-in-N chance per frame to flow sideways
+        int ignitionOdds;          // 1 in N per tick to catch fire past IGNITION_TEMP; 0 = never
+        float buoyancy;            // gases: upward acceleration as a fraction of GRAVITY
+        float heat;                // added to the temperature field per tick
+        bool alwaysActive;         // reacts every frame, so its chunk never sleeps
+        bool ages;                 // behaviour depends on lifeTime, so it is tracked
+        sf::Color baseColor;
+        ColorMode colorMode;
+        std::uint8_t colorJitter[3];  // Jitter: max +/- offset per RGB channel
+        const sf::Color* palette;     // Palette: colours indexed by variation
+        int paletteSize;
+        int paletteSpawnCount;        // new particles pick one of the first N entries
+        MotionParams motion;
+    };
+
+    // Entries 0-3 are spawn colours; burning fire flickers between 0-2 and 4
+    inline constexpr sf::Color FIRE_PALETTE[] = {
+        sf::Color(255, 80, 20, 255),
+        sf::Color(250, 150, 10, 255),
+        sf::Color(200, 150, 0, 255),
+        sf::Color(100, 50, 2, 255),
+        sf::Color(255, 200, 50, 255)
+    };
+    inline constexpr std::uint8_t FIRE_FLICKER_VARIATIONS[] = {0, 1, 2, 4};
+
+    // Embers spawn in their own colour and flicker through the fire spawn colours
+    inline constexpr sf::Color EMBER_PALETTE[] = {
+        MAT_COL_EMBER,
+        sf::Color(255, 80, 20, 255),
+        sf::Color(250, 150, 10, 255),
+        sf::Color(200, 150, 0, 255),
+        sf::Color(100, 50, 2, 255)
+    };
+
+    // Gases bubble up through liquids at most this viscous
+    constexpr int GAS_BUBBLE_MAX_VISCOSITY = 2;
+
+    // Indexed by MaterialID
+    inline constexpr std::array<MaterialProps, MATERIAL_COUNT> MATERIAL_TABLE = {{
+        // name        state                   dens  visc ign  buoy  heat   active ages   colour                          mode                  jitter        palette        n  spawn motion {grav, max, fric, side, maxSide, jitter, dampY, dampX}
+        {"Empty",     MaterialState::Empty,  0.0f, 0, 0,   0.0f, 0.0f,  false, false, MAT_COL_EMPTY,                   ColorMode::Jitter,    {0, 0, 0},    nullptr,       0, 0, {}},
+        {"Sand",      MaterialState::Powder, 1.6f, 0, 0,   0.0f, 0.0f,  false, false, MAT_COL_SAND,                    ColorMode::Jitter,    {20, 20, 20}, nullptr,       0, 0, {2.0f, 10.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}},
+        {"Water",     MaterialState::Liquid, 1.0f, 2, 0,   0.0f, 0.0f,  false, false, MAT_COL_WATER,                   ColorMode::Jitter,    {0, 0, 30},   nullptr,       0, 0, {1.0f, 10.0f, 0.98f, 2.0f, 5.0f, 0.8f, 0.7f, 0.8f}},
+        {"Salt",      MaterialState::Powder, 2.1f, 0, 0,   0.0f, 0.0f,  false, false, MAT_COL_SALT,                    ColorMode::Jitter,    {0, 0, 0},    nullptr,       0, 0, {1.0f, 15.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}},
+        {"Wood",      MaterialState::Static, 0.7f, 0, 160, 0.0f, 0.0f,  false, false, MAT_COL_WOOD,                    ColorMode::Jitter,    {10, 10, 0},  nullptr,       0, 0, {}},
+        {"Fire",      MaterialState::Static, 0.0f, 0, 0,   0.0f, 40.0f, true,  true,  MAT_COL_FIRE,                    ColorMode::Palette,   {0, 0, 0},    FIRE_PALETTE,  5, 4, {}},
+        {"Smoke",     MaterialState::Gas,    0.0f, 0, 0,   0.8f, 0.0f,  true,  true,  sf::Color(80, 70, 60, 255),      ColorMode::Fade,      {0, 0, 0},    nullptr,       0, 0, {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.2f, 0.0f, 0.0f}},
+        {"Ember",     MaterialState::Gas,    0.0f, 0, 0,   0.2f, 15.0f, true,  true,  MAT_COL_EMBER,                   ColorMode::Palette,   {0, 0, 0},    EMBER_PALETTE, 5, 1, {}},
+        {"Steam",     MaterialState::Gas,    0.0f, 0, 0,   1.0f, 0.0f,  true,  true,  sf::Color(220, 220, 250, 204),   ColorMode::FadeAlpha, {0, 0, 0},    nullptr,       0, 0, {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.8f, 0.0f, 0.0f}},
+        {"Gunpowder", MaterialState::Powder, 1.4f, 0, 1,   0.0f, 0.0f,  false, false, MAT_COL_GUNPOWDER,               ColorMode::Jitter,    {0, 0, 0},    nullptr,       0, 0, {1.0f, 15.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}},
+        {"Oil",       MaterialState::Liquid, 0.8f, 2, 50,  0.0f, 0.0f,  false, false, MAT_COL_OIL,                     ColorMode::Jitter,    {0, 0, 0},    nullptr,       0, 0, {1.0f, 10.0f, 0.98f, 1.5f, 5.0f, 0.8f, 0.7f, 0.8f}},
+        {"Lava",      MaterialState::Liquid, 3.0f, 5, 0,   0.0f, 12.0f, true,  false, MAT_COL_LAVA,                    ColorMode::Jitter,    {30, 10, 0},  nullptr,       0, 0, {0.85f, 8.0f, 0.95f, 0.8f, 4.0f, 0.3f, 0.8f, 0.85f}},
+        {"Stone",     MaterialState::Static, 2.5f, 0, 0,   0.0f, 0.0f,  false, false, MAT_COL_STONE,                   ColorMode::Jitter,    {20, 20, 20}, nullptr,       0, 0, {}},
+        {"Acid",      MaterialState::Liquid, 1.2f, 2, 0,   0.0f, 0.0f,  true,  false, MAT_COL_ACID,                    ColorMode::Jitter,    {0, 30, 0},   nullptr,       0, 0, {1.0f, 10.0f, 0.98f, 1.3f, 5.0f, 0.8f, 0.7f, 0.8f}}
+    }};
+
+    constexpr const MaterialProps& getMaterial(MaterialID id) {
+        return MATERIAL_TABLE[static_cast<std::size_t>(id)];
+    }
+
+    // Colour of a cell from its material and variation byte. Everything the
+    // renderer shows is derived from these two values, so files store only them.
+    constexpr sf::Color materialColor(MaterialID id, std::uint8_t variation) {
+        const MaterialProps& props = getMaterial(id);
+        sf::Color color = props.baseColor;
+        switch (props.colorMode) {
+            case ColorMode::Jitter: {
+                // Spread the byte over three channels, then map each to [-jitter, +jitter]
+                std::uint32_t hash = (variation + 1u) * 0x9E3779B1u;
+                std::uint8_t* channels[3] = {&color.r, &color.g, &color.b};
+                for (int c = 0; c < 3; ++c) {
+                    int jitter = props.colorJitter[c];
+                    int spread = static_cast<int>(((hash >> (8 * c + 5)) & 0xFF) * (2 * jitter + 1)) >> 8;
+                    *channels[c] = static_cast<std::uint8_t>(*channels[c] + spread - jitter);
+                }
+                break;
+            }
+            case ColorMode::Palette:
+                color = props.palette[variation < props.paletteSize ? variation : 0];
+                break;
+            case ColorMode::Fade:
+                color.r = static_cast<std::uint8_t>(color.r * variation / 255);
+                color.g = static_cast<std::uint8_t>(color.g * variation / 255);
+                color.b = static_cast<std::uint8_t>(color.b * variation / 255);
+                color.a = static_cast<std::uint8_t>(color.a * variation / 255);
+                break;
+            case ColorMode::FadeAlpha:
+                color.a = static_cast<std::uint8_t>(color.a * variation / 255);
+                break;
+        }
+        return color;
+    }
+}
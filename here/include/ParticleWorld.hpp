@@ -1,11 +1,18 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <utility>
 #include <vector>
 #include <memory>
 #include <cstdint>
 #include <SFML/Graphics.hpp>
 #include "Particle.hpp"
+#include "Chunk.hpp"
 #include "Constants.hpp"
 #include "Random.hpp"
+#include "ThreadPool.hpp"
+#include "WorldFile.hpp"
+#include "ChunkStore.hpp"
 #include <iostream>
 
 namespace SandSim
@@ -13,19 +20,71 @@ namespace SandSim
     class ParticleWorld
     {
     private:
-        std::vector<Particle> particles;
-        std::vector<std::uint8_t> pixelBuffer;
+        // Cell storage, one plane per field. Neighbour probes only touch the
+        // dense material plane. Colours are never stored: the renderer derives
+        // them from the material and variation planes.
+        std::vector<MaterialID> materials;
+        std::vector<std::uint8_t> variations;
+        std::vector<sf::Vector2f> velocities;
+        std::vector<float> lifeTimes;
+        // Frame in which each cell was last updated; never equal to frameCounter
+        // outside update(), so no per-frame reset is needed
+        std::vector<std::uint32_t> updateStamps;
+        // Consecutive updates in which each cell did nothing; reset by any
+        // dirty mark covering it. Scheduling state only, never saved or hashed.
+        std::vector<std::uint8_t> idleFrames;
+        // Hazard left before each cell's next reaction, see react(); 0 until
+        // first drawn. Belongs to the position, not the particle, so moves
+        // don't carry it. Like the random streams, never saved or hashed.
+        std::vector<float> reactionClocks;
+        // One bit per cell holding a material that updates or reacts, 16 cells
+        // to a word and activeStride words to a row. Updates walk these bits,
+        // so Empty, Stone and Wood cells are never visited.
+        std::vector<std::uint16_t> activeCells;
+        int activeStride = 0;
+        std::array<bool, MATERIAL_COUNT> dynamicMaterials{};
         int width, height;
+
+        // Temperature field, heatWidth x heatHeight cells of HEAT_CELL_SIZE
+        // squared. Hot materials add their heat as they update; updateHeat
+        // then diffuses it and applies the phase changes it drives.
+        std::vector<float> heat;
+        std::vector<float> heatScratch;
+        int heatWidth = 0, heatHeight = 0;
         uint32_t frameCounter;
 
+        // Dirty-rect chunks; only cells inside an active chunk's rect are simulated
+        std::vector<Chunk> chunks;
+        int chunksX, chunksY;
+        // Set when the planes were replaced wholesale, so per-chunk pixel rects don't apply
+        bool pixelsFullyDirty = true;
+
+        // Runs the checkerboard phases; null when running serially
+        std::unique_ptr<ThreadPool> threadPool;
+        std::vector<int> phaseChunks;
+
+        // Cells that ran a material update since construction
+        std::atomic<std::uint64_t> updatedCellCount{0};
+
+        // Streaming: the planes are a window onto a larger map paged through
+        // chunkStore, placed at originChunkX/Y in map chunks. Null otherwise.
+        std::shared_ptr<ChunkStore> chunkStore;
+        int originChunkX = 0;
+        int originChunkY = 0;
+
     public:
         // File I/O operations
         bool saveWorld(const std::string &baseFilename = "world");
         bool loadWorld(const std::string &filename);
         std::string getNextAvailableFilename(const std::string &baseName);
+
+        // Copy of the persistent planes, and the reverse; restore fails on a size mismatch
+        WorldSnapshot snapshot() const;
+        bool restore(const WorldSnapshot &source);
         
-        // Constructor - loads world file if specified
+        // Constructor - loads world file if specified; its size replaces w x h
         ParticleWorld(unsigned int w, unsigned int h, const std::string &worldFile = "");
+        ~ParticleWorld();
 
         // Reset world to empty state
         void clear();
@@ -33,50 +92,160 @@ namespace SandSim
         // Coordinate/bounds utilities
         int computeIndex(int x, int y) const { return y * width + x; }
         bool inBounds(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
-        bool isEmpty(int x, int y) const { return inBounds(x, y) && particles[computeIndex(x, y)].id == MaterialID::Empty; }
+        bool isEmpty(int x, int y) const { return inBounds(x, y) && materials[computeIndex(x, y)] == MaterialID::Empty; }
 
         // Particle access
-        Particle &getParticleAt(int x, int y) { return particles[computeIndex(x, y)]; }
-        const Particle &getParticleAt(int x, int y) const { return particles[computeIndex(x, y)]; }
+        MaterialID getMaterialAt(int x, int y) const { return materials[computeIndex(x, y)]; }
+        float getHeatAt(int x, int y) const { return heat[(y / HEAT_CELL_SIZE) * heatWidth + x / HEAT_CELL_SIZE]; }
+        ParticleRef getParticleAt(int x, int y)
+        {
+            int idx = computeIndex(x, y);
+            return ParticleRef{materials[idx], lifeTimes[idx], velocities[idx], variations[idx], updateStamps[idx], frameCounter};
+        }
+        Particle getParticleAt(int x, int y) const
+        {
+            int idx = computeIndex(x, y);
+            return Particle{materials[idx], lifeTimes[idx], velocities[idx], updateStamps[idx] == frameCounter, variations[idx]};
+        }
         void setParticleAt(int x, int y, const Particle &particle);
         void swapParticles(int x1, int y1, int x2, int y2);
 
         // Liquid detection utilities
         bool isInLiquid(int x, int y, int *lx, int *ly) const;
-        bool isInWater(int x, int y, int *lx, int *ly) const;
 
         // Main simulation update
         void update(float deltaTime);
 
-        // Rendering
-        const std::uint8_t *getPixelBuffer() const { return pixelBuffer.data(); }
+        // 64-bit hash of every cell's state, for replay divergence checks
+        std::uint64_t computeHash() const;
+
+        // Chunk activity
+        int getChunksX() const { return chunksX; }
+        int getChunksY() const { return chunksY; }
+        const Chunk &getChunk(int cx, int cy) const { return chunks[cy * chunksX + cx]; }
+        int getActiveChunkCount() const;
+        std::uint64_t getUpdatedCellCount() const { return updatedCellCount.load(std::memory_order_relaxed); }
+
+        // Worker threads for the checkerboard update (1 = serial)
+        void setWorkerCount(unsigned int count);
+        unsigned int getWorkerCount() const { return threadPool ? threadPool->getThreadCount() : 1; }
+
+        // Rendering: a cell's colour is materialColor(material, variation)
+        const MaterialID *getMaterialBuffer() const { return materials.data(); }
+        const std::uint8_t *getVariationBuffer() const { return variations.data(); }
+        // Regions whose colours changed since the last call, one rectangle per
+        // chunk row. Returns false when the whole buffer has to be uploaded.
+        bool takeDirtyPixelRects(std::vector<sf::IntRect> &rects);
         int getWidth() const { return width; }
         int getHeight() const { return height; }
 
-        // Particle placement/removal
+        // Particle placement/removal. Strokes cover every cell within radius of
+        // the segment between the two points, each cell visited once; filling
+        // only writes empty cells.
+        void addParticleStroke(int x0, int y0, int x1, int y1, float radius, MaterialID materialType);
+        void eraseStroke(int x0, int y0, int x1, int y1, float radius);
         void addParticleCircle(int centerX, int centerY, float radius, MaterialID materialType);
         void eraseCircle(int centerX, int centerY, float radius);
 
+        // Region operations. These overwrite whatever is in the region; filling
+        // with Empty clears it. Rectangles are inclusive and clipped to the world.
+        void fillRect(int x0, int y0, int x1, int y1, MaterialID materialType);
+        void clearRect(int x0, int y0, int x1, int y1) { fillRect(x0, y0, x1, y1, MaterialID::Empty); }
+        // Polygon vertices sit on cell corners; a cell is filled when its centre
+        // is inside (even-odd rule)
+        void fillPolygon(const std::vector<sf::Vector2i> &points, MaterialID materialType);
+        // Replaces the 4-connected region sharing the seed cell's material;
+        // returns the number of cells changed
+        int floodFill(int x, int y, MaterialID materialType);
+
+        // Streams the store's map through a resident window of at most
+        // residentChunkBudget chunks, never smaller than the view plus a chunk
+        // of margin on every side. Resident chunks are written back on destruction.
+        bool streamFrom(std::unique_ptr<ChunkStore> store, int residentChunkBudget, int viewWidth, int viewHeight);
+        bool isStreaming() const { return chunkStore != nullptr; }
+
+        // Recentres the window on the view (in map cells) once the view gets
+        // within a chunk of its edge. Chunks leaving the window are paged out,
+        // active or not; they resume when paged back in.
+        void followView(int viewX, int viewY, int viewWidth, int viewHeight);
+        void flushChunks();
+        // Copies of every resident chunk, for writing back off the frame
+        std::vector<ChunkPage> snapshotChunks() const;
+        std::shared_ptr<ChunkStore> getChunkStore() const { return chunkStore; }
+
+        // Map size and window position in cells; the window is the whole map when not streaming
+        int getMapWidth() const { return chunkStore ? chunkStore->getChunksX() * CHUNK_SIZE : width; }
+        int getMapHeight() const { return chunkStore ? chunkStore->getChunksY() * CHUNK_SIZE : height; }
+        int getOriginX() const { return originChunkX * CHUNK_SIZE; }
+        int getOriginY() const { return originChunkY * CHUNK_SIZE; }
+
     private:
-        // Factory method for creating particles by type
-        Particle createParticleByType(MaterialID type);
-
-        // Movement algorithms for different physics types
-        void updateLiquidMovement(int x, int y, float dt, float horizontalChance, float velocityMultiplier);
-        void updateSolidMovement(int x, int y, float dt, bool canDisplaceLiquids);
-        void updateGasMovement(int x, int y, float dt, float buoyancy, float horizontalDrift);
-
-        // Material-specific update functions
-        void updateSand(int x, int y, float dt);
-        void updateWater(int x, int y, float dt);
-        void updateSalt(int x, int y, float dt);
-        void updateFire(int x, int y, float dt);
-        void updateSmoke(int x, int y, float dt);
-        void updateEmber(int x, int y, float dt);
-        void updateSteam(int x, int y, float dt);
-        void updateGunpowder(int x, int y, float dt);
-        void updateOil(int x, int y, float dt);
-        void updateLava(int x, int y, float dt);
-        void updateAcid(int x, int y, float dt);
+        void allocate(int w, int h);
+        void wakeAllChunks();
+
+        // Window paging, in window chunk coordinates
+        void moveWindow(int newOriginX, int newOriginY);
+        void pageIn(int cx, int cy);
+        void pageOut(int cx, int cy);
+        WorldSnapshot copyChunk(int cx, int cy) const;
+
+        // Wake the cell and its 8 neighbours for the next frame, including any
+        // of them that had fallen asleep
+        void markDirty(int x, int y);
+        // Bulk versions for a changed block of cells (inclusive, clipped to the world)
+        void markDirtyRect(int x0, int y0, int x1, int y1);
+        void markPixelRect(int x0, int y0, int x1, int y1);
+        // Keeps the cell's activeCells bit in step with its material
+        void setActive(int x, int y, MaterialID id)
+        {
+            std::uint16_t bit = static_cast<std::uint16_t>(1u << (x % 16));
+            std::uint16_t &word = activeCells[y * activeStride + x / 16];
+            word = dynamicMaterials[static_cast<std::size_t>(id)] ? (word | bit) : (word & ~bit);
+        }
+        void rebuildActiveCells();
+        // Record a colour change for the next texture upload
+        void markPixel(int x, int y)
+        {
+            chunks[(y / CHUNK_SIZE) * chunksX + x / CHUNK_SIZE].pixels.expand(x, y, x, y);
+        }
+        void resetChunks();
+        // Fresh cells of one material over [left, right] of row y, without marking
+        void fillSpan(int y, int left, int right, MaterialID materialType);
+
+        // Calls span(y, left, right) for each row of the capsule around the
+        // segment, clipped to the world; one isqrt per row and end cap
+        template <typename SpanFn>
+        void forEachCapsuleSpan(int x0, int y0, int x1, int y1, float radius, SpanFn &&span) const;
+
+        // Checkerboard phases, on the thread pool when there is one
+        void updateChunks(float dt, bool leftToRight);
+        void updateChunk(int chunkIndex, float dt, bool leftToRight);
+        // Updates the active cells of [x0, x1] on row y in sweep order
+        std::uint64_t updateSpan(int y, int x0, int x1, float dt, bool leftToRight);
+        bool updateCell(int x, int y, float dt);
+
+        // Movement kernels, specialised per material from MATERIAL_TABLE
+        template <MaterialID M> void updatePowder(int x, int y, float dt);
+        template <MaterialID M> void updateLiquid(int x, int y, float dt);
+        template <MaterialID M> void updateGas(int x, int y, float dt);
+
+        // Per-material update; the generic version just runs the state's kernel,
+        // materials with extra rules are specialised in ParticleWorld.cpp
+        template <MaterialID M> void updateMaterial(int x, int y, float dt);
+
+        // Diffuses and cools the temperature field, then ignites, boils and
+        // explodes whatever lies in cells past the thresholds
+        void updateHeat();
+        // Rolls the cell's reactions against its 8 neighbours; true once the
+        // cell itself has turned into a product
+        bool react(int x, int y);
+        // Gunpowder blast: fire scattered within 4 cells
+        void explode(int x, int y);
+
+        // Dispatch table indexed by MaterialID; null for inert materials
+        using UpdateFn = void (ParticleWorld::*)(int, int, float);
+        template <std::size_t... I>
+        static constexpr std::array<UpdateFn, MATERIAL_COUNT> makeUpdateTable(std::index_sequence<I...>);
+        static const std::array<UpdateFn, MATERIAL_COUNT> updateTable;
     };
 }
\ No newline at end of file
@@ -1,44 +1,102 @@
 #pragma once
-#include <random>
+#include <cmath>
+#include <cstdint>
 
 namespace SandSim {
+    // xoshiro256** generator with per-thread state, so chunk workers can draw
+    // concurrently. Small draws (randBool, chance, randInt) are cut from a
+    // cached 64-bit word instead of pulling a fresh value every call.
     class Random {
     private:
-        static std::random_device rd;
-        static std::mt19937 gen;
-        static bool initialized;
-        
-        static void ensureInitialized() {
-            if (!initialized) {
-                gen.seed(rd());
-                initialized = true;
-            }
+        struct State {
+            std::uint64_t s[4];
+            std::uint64_t bits;
+            int bitsLeft;
+            bool initialized;
+        };
+
+        static thread_local inline State state{};
+        static inline std::uint64_t baseSeed = 0;
+
+        static void seedState(std::uint64_t seed);
+        static void seedFromEntropy();
+
+        static std::uint64_t rotl(std::uint64_t x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        static std::uint64_t step() {
+            std::uint64_t* s = state.s;
+            std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+            std::uint64_t t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+            return result;
         }
-        
+
+        // Uniform value in [0, range) via Lemire's multiply-shift
+        static std::uint32_t below(std::uint32_t range) {
+            return static_cast<std::uint32_t>((static_cast<std::uint64_t>(takeBits(32)) * range) >> 32);
+        }
+
     public:
-        static void setSeed(uint32_t seed) {
-            gen.seed(seed);
-            initialized = true;
+        // Seeds the calling thread and sets the base for seedStream
+        static void setSeed(std::uint64_t seed);
+
+        // Seeds the calling thread with an independent stream derived from the
+        // base seed, e.g. (frame, chunk index) so parallel updates don't depend
+        // on which worker picks up which chunk
+        static void seedStream(std::uint64_t a, std::uint64_t b);
+
+        // Next 64 random bits
+        static std::uint64_t nextBits() {
+            if (!state.initialized) seedFromEntropy();
+            return step();
         }
-        
+
+        // Low `count` bits (1..32) of the cached word, refilled when it runs out
+        static std::uint32_t takeBits(int count) {
+            if (state.bitsLeft < count) {
+                state.bits = nextBits();
+                state.bitsLeft = 64;
+            }
+            std::uint32_t result = static_cast<std::uint32_t>(state.bits & ((std::uint64_t(1) << count) - 1));
+            state.bits >>= count;
+            state.bitsLeft -= count;
+            return result;
+        }
+
         static int randInt(int min, int max) {
-            ensureInitialized();
-            std::uniform_int_distribution<int> dis(min, max);
-            return dis(gen);
+            return min + static_cast<int>(below(static_cast<std::uint32_t>(max - min) + 1));
         }
-        
+
         static float randFloat(float min, float max) {
-            ensureInitialized();
-            std::uniform_real_distribution<float> dis(min, max);
-            return dis(gen);
+            return min + (max - min) * (takeBits(24) * (1.0f / 16777216.0f));
         }
-        
+
+        // Exponentially distributed with mean 1, in [0, 16.7)
+        static float exponential() {
+            return -std::log((takeBits(24) + 1) * (1.0f / 16777216.0f));
+        }
+
         static bool randBool() {
-            return randInt(0, 1) == 1;
+            return takeBits(1) != 0;
         }
-        
+
         static bool chance(int oneInN) {
-            return randInt(0, oneInN - 1) == 0;
+            if (oneInN <= 1) return true;
+            std::uint32_t n = static_cast<std::uint32_t>(oneInN);
+            if ((n & (n - 1)) == 0) {
+                // Power of two: only log2(n) bits are needed
+                int width = 0;
+                while ((std::uint32_t(1) << width) < n) ++width;
+                return takeBits(width) == 0;
+            }
+            return below(n) == 0;
         }
     };
-}
\ No newline at end of file
+}
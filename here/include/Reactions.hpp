@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <string>
+#include "Constants.hpp"
+
+namespace SandSim {
+    // What an updating cell does next to a given neighbour. A product equal
+    // to the material it replaces leaves that cell untouched.
+    struct Reaction {
+        int oneInN = 0;                                   // mean wait in ticks beside this neighbour; 0 = none
+        MaterialID product = MaterialID::Empty;           // what the updating cell becomes
+        MaterialID neighbourProduct = MaterialID::Empty;  // what the neighbour becomes
+        float heat = 0.0f;                                // added to the temperature field
+        float hazard = 0.0f;                              // -ln(1 - 1/oneInN), see ParticleWorld::react
+    };
+
+    // Indexed by the neighbour's MaterialID
+    using ReactionRow = std::array<Reaction, MATERIAL_COUNT>;
+
+    // Pairwise reactions indexed by (material, neighbour). Starts with the
+    // built-in set; load replaces it from a text file, one reaction per line:
+    //   <material> <neighbour> <mean ticks> <product> <neighbour product> [heat]
+    // Load before creating any world; the table is shared by every thread and
+    // worlds note which materials react when they allocate.
+    class ReactionTable {
+    private:
+        struct Table {
+            std::array<ReactionRow, MATERIAL_COUNT> rows{};
+            std::array<bool, MATERIAL_COUNT> reactive{};
+        };
+
+        static Table makeDefaults();
+        static inline Table table = makeDefaults();
+
+    public:
+        static const ReactionRow& row(MaterialID id) {
+            return table.rows[static_cast<std::size_t>(id)];
+        }
+
+        // Whether the material has any reaction, so its neighbours need checking
+        static bool reacts(MaterialID id) {
+            return table.reactive[static_cast<std::size_t>(id)];
+        }
+
+        // Keeps the current table if the file is missing or malformed
+        static bool load(const std::string& filename);
+    };
+}
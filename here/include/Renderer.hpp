@@ -1,6 +1,8 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <vector>
 #include "ParticleWorld.hpp"
+#include "WorldFrame.hpp"
 #include "Constants.hpp"
 
 namespace SandSim {
@@ -9,25 +11,69 @@ namespace SandSim {
         sf::Texture particleTexture;
         sf::Sprite particleSprite;
         
-        // Post-processing components
+        // Post-processing components. The bloom chain runs at half and quarter
+        // resolution; all targets live as long as the Renderer and are only
+        // recreated when the view size changes.
         sf::RenderTexture renderTexture;
+        sf::RenderTexture brightTexture;
+        sf::RenderTexture blurTexture1;
+        sf::RenderTexture blurTexture2;
+        sf::Vector2u postProcessSize;
+        static constexpr unsigned int BRIGHT_DOWNSAMPLE = 2;
+        static constexpr unsigned int BLUR_DOWNSAMPLE = 4;
         sf::Shader blurShader;
         sf::Shader bloomShader;
         sf::Shader enhanceShader;
         bool usePostProcessing;
         
+        // Cell colours are materialColor(material, variation). With the palette
+        // shader, cells are uploaded two per texel as (material, variation)
+        // byte pairs and coloured on the GPU into colorTarget; otherwise the CPU
+        // expands them through colorTable into the RGBA particle texture.
+        sf::Texture cellTexture;
+        sf::Texture paletteTexture;
+        sf::Shader paletteShader;
+        sf::RenderTexture colorTarget;
+        std::vector<sf::Color> colorTable;
+        bool useIndexedColors;
+        
+        // Part of the world texture on screen, at most TEXTURE_WIDTH x TEXTURE_HEIGHT
+        sf::IntRect viewRect;
+        // Coloured view that the direct and post-processed paths draw from
+        const sf::Texture* sceneTexture;
+        sf::IntRect sceneRect;
+        
+        // Partial uploads: changed regions this frame, staged as packed texels
+        std::vector<sf::IntRect> dirtyRects;
+        std::vector<sf::Color> uploadBuffer;
+        bool textureStale;
+        // Sequence of the last WorldFrame uploaded, so a frame shown twice is uploaded once
+        std::uint64_t uploadedFrame;
+        // Past this fraction of the world's cells, one full upload is cheaper
+        static constexpr float FULL_UPLOAD_FRACTION = 0.5f;
+        
     public:
         Renderer();
         
         void setupShaders();
-        void updateTexture(const ParticleWorld& world);
-        void render(sf::RenderWindow& window, const ParticleWorld& world);
+        void setupPalette();
+        void render(sf::RenderWindow& window, ParticleWorld& world, sf::Vector2i viewOffset = {0, 0});
+        // Same, from a frame published by the simulation thread
+        void render(sf::RenderWindow& window, const WorldFrame& frame, sf::Vector2i viewOffset = {0, 0});
         void setUsePostProcessing(bool use);
         bool getUsePostProcessing() const;
+        void setUseIndexedColors(bool use);
+        bool getUseIndexedColors() const;
         void scaleToWindow(sf::RenderWindow& window);
         
     private:
         void renderDirect(sf::RenderWindow& window);
         void renderWithPostProcessing(sf::RenderWindow& window);
+        bool resizePostProcessing(sf::Vector2u size);
+        // Uploads dirtyRects, or the whole grid if !partial
+        void updateTexture(int width, int height, const MaterialID* materials, const std::uint8_t* variations, bool partial);
+        void uploadRegion(int width, const MaterialID* materials, const std::uint8_t* variations, const sf::IntRect& rect);
+        void present(sf::RenderWindow& window, sf::Vector2i worldSize, sf::Vector2i viewOffset);
+        void colorizeView();
     };
 }
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Constants.hpp"
+
+namespace SandSim {
+    class ParticleWorld;
+
+    enum class ReplayCommandType : std::uint8_t {
+        Brush,       // addParticleCircle(x, y, radius, material)
+        Erase,       // eraseCircle(x, y, radius)
+        Clear,       // clear()
+        SetWorkers,  // setWorkerCount(workers)
+        Stroke,      // addParticleStroke(x, y, x2, y2, radius, material)
+        EraseStroke  // eraseStroke(x, y, x2, y2, radius)
+    };
+
+    // One world mutation, applied before the update of `frame`
+    struct ReplayCommand {
+        ReplayCommandType type;
+        std::uint32_t frame;
+        std::int32_t x;
+        std::int32_t y;
+        std::int32_t x2;
+        std::int32_t y2;
+        float radius;
+        MaterialID material;
+        std::uint8_t workers;
+    };
+
+    // Everything needed to re-run a session: the starting level, the seed, the
+    // fixed timestep, every input command, and the world hash after each frame.
+    class ReplayLog {
+    public:
+        std::uint64_t seed = 0;
+        float timeStep = 1.0f / 60.0f;
+        std::string worldFile;
+        std::uint64_t initialHash = 0;
+        std::vector<ReplayCommand> commands;
+        std::vector<std::uint64_t> frameHashes;
+
+        void addCommand(const ReplayCommand& command) { commands.push_back(command); }
+        std::uint32_t getFrameCount() const { return static_cast<std::uint32_t>(frameHashes.size()); }
+
+        bool save(const std::string& filename) const;
+        bool load(const std::string& filename);
+
+        static void apply(ParticleWorld& world, const ReplayCommand& command);
+    };
+
+    struct ReplayResult {
+        std::int64_t divergentFrame = -1;  // -1 if every frame matched; 0 is the initial state
+        std::uint64_t expectedHash = 0;
+        std::uint64_t actualHash = 0;
+    };
+
+    // Re-runs the log headlessly and stops at the first frame whose hash differs
+    ReplayResult runReplay(const ReplayLog& log);
+}
@@ -9,6 +9,9 @@
 #include "Random.hpp"
 #include "GameState.hpp"
 #include "LevelMenu.hpp"
+#include "Replay.hpp"
+#include "FixedTimestep.hpp"
+#include "SimulationThread.hpp"
 namespace SandSim {
     class SandSimApp {
     private:
@@ -25,13 +28,36 @@ namespace SandSim {
         bool running;
         bool simulationRunning;
         float frameTime;
+        // Real time is turned into whole ticks of this fixed step
+        int tickRate;
+        FixedTimestep timestep;
+        unsigned int workerCount;  // simulation threads, 1 = serial update
         
         // Mouse tracking for continuous drawing
         sf::Vector2f previousMouseWorldPos;
         bool hasPreviousMousePos;
         
+        // Input recording for deterministic replay; empty path = not recording
+        std::string recordPath;
+        std::unique_ptr<ReplayLog> recording;
+        
+        // Streamed map directory (empty = levels only) and its resident chunk budget
+        std::string mapPath;
+        int chunkBudget;
+        
+        // Top-left of the view in map cells, and the map's size for the session
+        sf::Vector2i camera;
+        sf::Vector2i mapSize;
+        
+        // With --sim-thread the world ticks on its own thread and is only
+        // reached through it; null when the main loop updates the world
+        bool useSimulationThread;
+        std::unique_ptr<SimulationThread> simulation;
+        
     public:
-        SandSimApp();
+        explicit SandSimApp(const std::string& recordPath = "", const std::string& mapPath = "",
+                            int chunkBudget = DEFAULT_RESIDENT_CHUNK_BUDGET, bool simulationThread = false,
+                            int tickRate = DEFAULT_TICK_RATE);
         void run();
         
     private:
@@ -46,6 +72,12 @@ namespace SandSim {
         void handleGameEvents(const sf::Event& event);
         void returnToMenu();
         void startGame(const std::string& worldFile);
+        void startMap();
+        void startSimulation();
+        
+        // Camera over worlds larger than the view
+        void handleCameraKeys();
+        sf::Vector2i getViewOffset() const;
         
         // Coordinate conversion
         sf::Vector2f screenToWorldCoordinates(const sf::Vector2f& screenPos);
@@ -59,6 +91,11 @@ namespace SandSim {
         void addParticlesLine(const sf::Vector2f& startPos, const sf::Vector2f& endPos);
         void eraseParticlesLine(const sf::Vector2f& startPos, const sf::Vector2f& endPos);
         
+        // Replay recording
+        void recordCommand(ReplayCommandType type, int x = 0, int y = 0, int x2 = 0, int y2 = 0, float radius = 0.0f,
+                           MaterialID material = MaterialID::Empty);
+        void finishRecording();
+        
         // Game loop
         void update();
         void render();
@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "FixedTimestep.hpp"
+#include "ParticleWorld.hpp"
+#include "Replay.hpp"
+#include "TripleBuffer.hpp"
+#include "WorldFrame.hpp"
+
+namespace SandSim {
+    // World mutation requested by the input thread. Positions are map cells;
+    // the simulation thread converts them to the resident window when applied.
+    struct SimCommand {
+        enum class Type : std::uint8_t {
+            Brush,       // addParticleStroke(x, y, x2, y2, radius, material)
+            Erase,       // eraseStroke(x, y, x2, y2, radius)
+            Clear,       // clear()
+            SetWorkers,  // setWorkerCount(workers)
+            FollowView   // followView(x, y) with the view size
+        };
+
+        Type type;
+        int x = 0;
+        int y = 0;
+        int x2 = 0;
+        int y2 = 0;
+        float radius = 0.0f;
+        MaterialID material = MaterialID::Empty;
+        unsigned int workers = 1;
+    };
+
+    // Ticks a ParticleWorld on its own thread, so a slow frame delays neither
+    // input nor presentation. Input arrives through post(); each tick or batch
+    // of commands publishes a WorldFrame through a triple buffer that the
+    // render thread reads without blocking.
+    class SimulationThread {
+    public:
+        // Starts ticking immediately. The world must outlive this object and
+        // must not be touched by other threads except under lockWorld().
+        // A non-null recording receives commands and frame hashes as they are
+        // applied; its timeStep should match the tick rate.
+        SimulationThread(ParticleWorld& world, int tickRate = DEFAULT_TICK_RATE, ReplayLog* recording = nullptr);
+        ~SimulationThread();
+
+        SimulationThread(const SimulationThread&) = delete;
+        SimulationThread& operator=(const SimulationThread&) = delete;
+
+        // Queues a command for the start of the next tick
+        void post(const SimCommand& command);
+
+        // Pausing stops the updates; commands are still applied and published
+        void setRunning(bool running) { ticking.store(running, std::memory_order_relaxed); }
+
+        // Render thread: switches to the newest published frame, false if none is new
+        bool consumeFrame() { return frames.consume(); }
+        const WorldFrame& getFrame() const { return frames.front(); }
+
+        // Holds the simulation between ticks while the caller uses the world directly
+        std::unique_lock<std::mutex> lockWorld() { return std::unique_lock<std::mutex>(worldMutex); }
+
+    private:
+        ParticleWorld& world;
+        ReplayLog* recording;
+        FixedTimestep timestep;
+        std::thread thread;
+        std::mutex worldMutex;
+
+        // Commands posted since the last tick
+        std::mutex commandMutex;
+        std::condition_variable wakeCondition;
+        std::vector<SimCommand> pendingCommands;
+        std::vector<SimCommand> activeCommands;
+        std::atomic<bool> ticking;
+        bool stopping;
+
+        TripleBuffer<WorldFrame> frames;
+        std::vector<sf::IntRect> tickRects;
+        // Sequence of the last published frame, recorded in the next one
+        std::uint64_t publishedSequence = 0;
+        // Past this many rects the renderer may as well upload everything
+        static constexpr std::size_t MAX_FRAME_RECTS = 1024;
+
+        void loop();
+        void apply(const SimCommand& command);
+        void publishFrame();
+    };
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SandSim {
+    // Fixed set of worker threads that run index-based batches. The calling
+    // thread takes part in every batch, so a pool of N threads spawns N - 1.
+    class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wakeCondition;
+        std::condition_variable doneCondition;
+
+        const std::function<void(std::size_t)>* currentTask;
+        std::size_t taskCount;
+        std::atomic<std::size_t> nextTask;
+        std::size_t busyWorkers;
+        std::uint64_t generation;
+        bool stopping;
+
+    public:
+        explicit ThreadPool(unsigned int threadCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        unsigned int getThreadCount() const { return static_cast<unsigned int>(workers.size()) + 1; }
+
+        // Runs task(i) for every i in [0, count) and blocks until all are done
+        void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task);
+
+    private:
+        void workerLoop();
+        void runTasks();
+    };
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "WorldFile.hpp"
+
+namespace SandSim {
+    // World thumbnails keyed on path + modification time + size. Entries live in
+    // memory and are persisted to a cache file, so a world file is only opened
+    // again after it changes.
+    class ThumbnailCache {
+    public:
+        explicit ThumbnailCache(const std::string& cacheFile);
+
+        // Thumbnail for the world file, read from disk only on a cache miss; null on failure
+        const WorldThumbnail* get(const std::string& worldFile);
+
+        // Drops entries not requested since the last flush, then saves if anything changed
+        void flush();
+
+    private:
+        struct Entry {
+            std::int64_t modified = 0;
+            std::uint64_t size = 0;
+            WorldThumbnail thumbnail;
+            bool used = false;
+        };
+
+        std::string cacheFile;
+        std::unordered_map<std::string, Entry> entries;
+        bool changed = false;
+
+        void load();
+        bool save() const;
+    };
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <array>
+#include <atomic>
+
+namespace SandSim {
+    // Lock-free single-producer, single-consumer handoff of the latest value.
+    // The writer fills back() and publishes it; the reader picks up the newest
+    // published slot with consume(). Neither side ever waits, and a value the
+    // reader was too slow to see is replaced rather than queued.
+    template <typename T>
+    class TripleBuffer {
+    public:
+        // Writer side. publish() returns true if it replaced a value the reader
+        // never consumed; that value's slot is the new back().
+        T& back() { return slots[backIndex]; }
+
+        bool publish() {
+            int previous = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel);
+            backIndex = previous & INDEX;
+            return (previous & FRESH) != 0;
+        }
+
+        // Reader side. False, keeping the current front(), if nothing new was published.
+        bool consume() {
+            if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+                return false;
+            }
+            int previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+            frontIndex = previous & INDEX;
+            return true;
+        }
+
+        const T& front() const { return slots[frontIndex]; }
+
+    private:
+        static constexpr int INDEX = 3;
+        static constexpr int FRESH = 4;
+
+        std::array<T, 3> slots;
+        int backIndex = 0;
+        std::atomic<int> middle{1};
+        int frontIndex = 2;
+    };
+}
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include "Constants.hpp"
+#include "WorldSaver.hpp"
 
 namespace SandSim {
     // Forward declaration
@@ -78,6 +79,10 @@ namespace SandSim {
         // Reference to world for saving
         ParticleWorld* world;
         
+        // Background file writer; the button shows its progress and result
+        WorldSaver saver;
+        sf::Clock saveStatusClock;
+        
     public:
         UI(ParticleWorld* worldPtr);
         
@@ -107,6 +112,8 @@ namespace SandSim {
         bool isPointInRect(const sf::Vector2f& point, const sf::Vector2i& rectPos, const sf::Vector2i& rectSize) const;
         void drawMaterialPanel();
         void drawSaveButton();  // New method
+        void setSaveButtonText(const std::string& text);
+        void updateSaveStatus();
         void drawSelectionCircle();
         bool loadFont();
     };
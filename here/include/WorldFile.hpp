@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/System/Vector2.hpp>
+#include "Constants.hpp"
+
+namespace SandSim {
+    // Copy of a world's persistent cell planes, detached from any ParticleWorld
+    struct WorldSnapshot {
+        int width = 0;
+        int height = 0;
+        std::uint32_t frameCounter = 0;
+        std::vector<MaterialID> materials;
+        std::vector<std::uint8_t> variations;
+        std::vector<sf::Vector2f> velocities;
+        std::vector<float> lifeTimes;
+        // Only filled by v1 files, which stored colours instead of variations;
+        // their variations are approximated from these on load
+        std::vector<sf::Color> colors;
+    };
+
+    // Pre-downscaled RGBA preview of a world; empty areas are transparent
+    struct WorldThumbnail {
+        unsigned int width = 0;
+        unsigned int height = 0;
+        std::vector<std::uint8_t> pixels;
+    };
+
+    // .rrr world files.
+    //   v1: int width, int height, u32 frame, then 17 bytes per cell
+    //       (id, velocity.x, velocity.y, lifeTime, r, g, b, a)
+    //   v2: "RRR2", u16 version, u16 flags, i32 width, i32 height, u32 frame,
+    //       if flags has FLAG_THUMBNAIL: u16 width, u16 height, RGBA thumbnail,
+    //       material runs (id byte + varint length) covering every cell,
+    //       one variation byte per non-empty cell,
+    //       varint record count, then per record a varint index delta, a field
+    //       mask and the velocity and/or lifeTime that differ from zero
+    namespace WorldFile {
+        constexpr std::uint16_t VERSION = 2;
+        constexpr std::uint16_t FLAG_THUMBNAIL = 1;
+        constexpr int THUMBNAIL_SCALE = 4;       // minimum world cells per thumbnail pixel, per axis
+        constexpr int THUMBNAIL_MAX_SIZE = 160;  // larger worlds are downscaled further
+
+        std::vector<char> encode(const WorldSnapshot& snapshot, bool withThumbnail = true);
+        bool decode(const std::vector<char>& data, WorldSnapshot& snapshot);
+
+        // Whole file in one buffered write / read
+        bool write(const std::string& filename, const WorldSnapshot& snapshot, bool withThumbnail = true);
+        bool read(const std::string& filename, WorldSnapshot& snapshot);
+
+        WorldThumbnail makeThumbnail(const WorldSnapshot& snapshot);
+
+        // Reads just the header and the embedded thumbnail. Files without one
+        // (v1, or v2 written before thumbnails) are decoded in full instead.
+        bool readThumbnail(const std::string& filename, WorldThumbnail& thumbnail);
+    }
+}
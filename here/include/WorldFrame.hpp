@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <SFML/Graphics/Rect.hpp>
+#include "Constants.hpp"
+
+namespace SandSim {
+    // Copy of what the renderer needs from one simulated frame: the cell
+    // planes it colours, where the window sits on the map, and what changed
+    // since the previous frame the simulation published.
+    struct WorldFrame {
+        std::uint64_t sequence = 0;  // 0 until the first frame is published
+        std::uint64_t previousSequence = 0;  // the frame dirtyRects are relative to
+        int width = 0;
+        int height = 0;
+        int originX = 0;
+        int originY = 0;
+        std::vector<MaterialID> materials;
+        std::vector<std::uint8_t> variations;
+        std::vector<sf::IntRect> dirtyRects;
+        bool fullyDirty = true;
+    };
+}
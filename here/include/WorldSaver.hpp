@@ -0,0 +1,60 @@
+#pragma once
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ChunkStore.hpp"
+#include "WorldFile.hpp"
+
+namespace SandSim {
+    // Encodes and writes world snapshots on a background thread, so the caller
+    // only pays for copying the grid. One save is in flight at a time; pending
+    // writes are finished before destruction.
+    class WorldSaver {
+    public:
+        enum class Status {
+            Idle,
+            Saving,
+            Saved,
+            Failed
+        };
+
+        WorldSaver();
+        ~WorldSaver();
+
+        WorldSaver(const WorldSaver&) = delete;
+        WorldSaver& operator=(const WorldSaver&) = delete;
+
+        // Queues the snapshot for writing; false if a save is already in flight
+        bool save(WorldSnapshot snapshot, const std::string& filename);
+        // Same for a streamed map's resident chunks, written back into its store.
+        // Call while the pages are current: chunks the world pages out after
+        // this call are newer and won't be overwritten by these copies.
+        bool saveChunks(std::shared_ptr<ChunkStore> store, std::vector<ChunkPage> pages);
+
+        // Saving while a write is in flight; otherwise the result of the last
+        // finished save (reported once, then Idle). filename receives its target.
+        Status poll(std::string& filename);
+
+    private:
+        std::thread writer;
+        std::mutex mutex;
+        std::condition_variable wakeCondition;
+
+        WorldSnapshot pending;
+        std::shared_ptr<ChunkStore> pendingStore;  // set for a chunk save
+        std::vector<ChunkPage> pendingPages;
+        std::uint64_t pendingVersion;
+        std::string pendingFilename;
+        bool hasPending;
+        bool writing;
+        bool stopping;
+
+        Status finished;
+        std::string finishedFilename;
+
+        void writerLoop();
+    };
+}
@@ -0,0 +1,99 @@
+#include "ChunkStore.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace SandSim {
+
+namespace {
+    const char MAP_MAGIC[4] = {'R', 'R', 'M', 'P'};
+    const std::uint32_t MAP_VERSION = 1;
+    const char* MAP_INFO_FILE = "map.info";
+}
+
+bool ChunkStore::open(const std::string& directory, int chunksX, int chunksY)
+{
+    this->directory = directory;
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    std::string infoPath = directory + "/" + MAP_INFO_FILE;
+
+    std::ifstream info(infoPath, std::ios::binary);
+    if (info.is_open()) {
+        char magic[4];
+        std::uint32_t version = 0;
+        if (!info.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, MAP_MAGIC) ||
+            !info.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != MAP_VERSION ||
+            !info.read(reinterpret_cast<char*>(&this->chunksX), sizeof(this->chunksX)) ||
+            !info.read(reinterpret_cast<char*>(&this->chunksY), sizeof(this->chunksY))) {
+            std::cerr << "Not a supported chunk store: " << directory << std::endl;
+            return false;
+        }
+        return this->chunksX > 0 && this->chunksY > 0;
+    }
+
+    std::ofstream out(infoPath, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Failed to create chunk store: " << directory << std::endl;
+        return false;
+    }
+    this->chunksX = chunksX;
+    this->chunksY = chunksY;
+    out.write(MAP_MAGIC, sizeof(MAP_MAGIC));
+    out.write(reinterpret_cast<const char*>(&MAP_VERSION), sizeof(MAP_VERSION));
+    out.write(reinterpret_cast<const char*>(&chunksX), sizeof(chunksX));
+    out.write(reinterpret_cast<const char*>(&chunksY), sizeof(chunksY));
+    return static_cast<bool>(out);
+}
+
+bool ChunkStore::read(int cx, int cy, WorldSnapshot& chunk) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string path = chunkPath(cx, cy);
+    if (!std::filesystem::exists(path)) {
+        return false;
+    }
+    return WorldFile::read(path, chunk) && chunk.width == CHUNK_SIZE && chunk.height == CHUNK_SIZE;
+}
+
+bool ChunkStore::write(int cx, int cy, const WorldSnapshot& chunk)
+{
+    return write(cx, cy, chunk, reserveVersion());
+}
+
+std::uint64_t ChunkStore::reserveVersion()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return nextVersion++;
+}
+
+bool ChunkStore::write(int cx, int cy, const WorldSnapshot& chunk, std::uint64_t version)
+{
+    // Held through the file write, so a read never sees a half-written page
+    std::lock_guard<std::mutex> lock(mutex);
+    std::uint64_t& written = writtenVersions[{cx, cy}];
+    if (written > version) {
+        return true;
+    }
+    written = version;
+
+    std::string path = chunkPath(cx, cy);
+
+    // Keep the store sparse: an empty chunk is the same as a missing page
+    bool empty = std::all_of(chunk.materials.begin(), chunk.materials.end(),
+                             [](MaterialID id) { return id == MaterialID::Empty; });
+    if (empty) {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        return true;
+    }
+    return WorldFile::write(path, chunk, false);
+}
+
+std::string ChunkStore::chunkPath(int cx, int cy) const
+{
+    return directory + "/" + std::to_string(cx) + "_" + std::to_string(cy) + ".chunk";
+}
+
+} // namespace SandSim
@@ -1,5 +1,4 @@
 #include "LevelMenu.hpp"
-#include "ParticleWorld.hpp"
 #include <filesystem>
 #include <iostream>
 #include <algorithm>
@@ -11,7 +10,8 @@ namespace SandSim
     const float LevelMenu::ASPECT_RATIO = 4.0f / 3.0f; // 4:3 aspect ratio
 
     LevelMenu::LevelMenu(int levelsPerRow, float paddingPercent)
-        : scrollOffset(0), maxScrollOffset(0), isDragging(false),
+        : thumbnailCache("worlds/thumbnails.cache"),
+          scrollOffset(0), maxScrollOffset(0), isDragging(false),
           selectedLevel(-1), fontLoaded(false),
           levelsPerRow(levelsPerRow), paddingPercent(paddingPercent),
           menuTexture(sf::Vector2u(TEXTURE_WIDTH, TEXTURE_HEIGHT)),
@@ -158,8 +158,8 @@ namespace SandSim
                     level.filename = entry.path().string();
                     level.displayName = entry.path().stem().string();
 
-                    // Generate thumbnail
-                    generateThumbnail(level.filename, level.thumbnail);
+                    // Embedded thumbnail, only read from disk when the file changed
+                    loadThumbnail(level.filename, level.thumbnail);
 
                     // Check if thumbnail was generated successfully
                     sf::Vector2u thumbSize = level.thumbnail.getSize();
@@ -203,6 +203,8 @@ namespace SandSim
             std::cerr << "Error loading levels from " << worldsDir << ": " << e.what() << std::endl;
         }
 
+        thumbnailCache.flush();
+
         std::cout << "Loaded " << levels.size() << " levels from " << worldsDir << " directory" << std::endl;
     }
 
@@ -213,50 +215,18 @@ namespace SandSim
         std::cout << "Level menu refreshed with " << levels.size() << " levels" << std::endl;
     }
 
-    void LevelMenu::generateThumbnail(const std::string &worldFile, sf::Texture &thumbnail)
+    void LevelMenu::loadThumbnail(const std::string &worldFile, sf::Texture &thumbnail)
     {
-        try
+        const WorldThumbnail *cached = thumbnailCache.get(worldFile);
+        if (!cached)
         {
-            ParticleWorld tempWorld(TEXTURE_WIDTH, TEXTURE_HEIGHT);
-
-            if (tempWorld.loadWorld(worldFile))
-            {
-                const std::uint8_t *pixelBuffer = tempWorld.getPixelBuffer();
-
-                if (pixelBuffer)
-                {
-                    sf::Vector2u imageSize(tempWorld.getWidth(), tempWorld.getHeight());
-
-                    std::vector<std::uint8_t> fixedPixelBuffer(imageSize.x * imageSize.y * 4);
-                    for (unsigned int i = 0; i < imageSize.x * imageSize.y; ++i)
-                    {
-                        unsigned int idx = i * 4;
-
-                        fixedPixelBuffer[idx] = pixelBuffer[idx];         // R
-                        fixedPixelBuffer[idx + 1] = pixelBuffer[idx + 1]; // G
-                        fixedPixelBuffer[idx + 2] = pixelBuffer[idx + 2]; // B
-
-                        if (pixelBuffer[idx] == 0 && pixelBuffer[idx + 1] == 0 && pixelBuffer[idx + 2] == 0)
-                        {
-                            fixedPixelBuffer[idx + 3] = 0;
-                        }
-                        else
-                        {
-                            fixedPixelBuffer[idx + 3] = 255;
-                        }
-                    }
-
-                    sf::Image worldImage(imageSize, fixedPixelBuffer.data());
-                    if (!thumbnail.loadFromImage(worldImage))
-                    {
-                        std::cerr << "Failed to load thumbnail from image for: " << worldFile << std::endl;
-                    }
-                }
-            }
+            return;
         }
-        catch (const std::exception &e)
+
+        sf::Image image(sf::Vector2u(cached->width, cached->height), cached->pixels.data());
+        if (!thumbnail.loadFromImage(image))
         {
-            std::cerr << "Error generating thumbnail: " << e.what() << std::endl;
+            std::cerr << "Failed to load thumbnail from image for: " << worldFile << std::endl;
         }
     }
 
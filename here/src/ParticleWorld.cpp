@@ -1,6 +1,11 @@
 #include "ParticleWorld.hpp"
+#include "WorldFile.hpp"
+#include "Reactions.hpp"
 #include <algorithm>
+#include <climits>
 #include <cmath>
+#include <limits>
+#include <cstring>
 #include <string>
 #include <fstream>
 #include <filesystem>
@@ -9,10 +14,9 @@ namespace SandSim
 {
 
 ParticleWorld::ParticleWorld(unsigned int w, unsigned int h, const std::string &worldFile)
-    : width(w), height(h), frameCounter(0)
+    : width(0), height(0), frameCounter(0)
 {
-    particles.resize(width * height);
-    pixelBuffer.resize(width * height * 4); // RGBA
+    allocate(static_cast<int>(w), static_cast<int>(h));
 
     if (!worldFile.empty() && std::filesystem::exists(worldFile))
     {
@@ -28,13 +32,151 @@ ParticleWorld::ParticleWorld(unsigned int w, unsigned int h, const std::string &
     }
 }
 
+ParticleWorld::~ParticleWorld()
+{
+    if (chunkStore)
+        flushChunks();
+}
+
+void ParticleWorld::allocate(int w, int h)
+{
+    width = w;
+    height = h;
+    std::size_t cellCount = static_cast<std::size_t>(width) * height;
+
+    materials.assign(cellCount, MaterialID::Empty);
+    variations.assign(cellCount, 0);
+    velocities.assign(cellCount, sf::Vector2f(0.0f, 0.0f));
+    lifeTimes.assign(cellCount, 0.0f);
+    updateStamps.assign(cellCount, 0);
+    idleFrames.assign(cellCount, 0);
+    reactionClocks.assign(cellCount, 0.0f);
+
+    // Reactions are loaded before any world exists, so this stays valid
+    for (std::size_t i = 0; i < MATERIAL_COUNT; ++i)
+        dynamicMaterials[i] = updateTable[i] != nullptr || ReactionTable::reacts(static_cast<MaterialID>(i));
+    activeStride = (width + 15) / 16;
+    activeCells.assign(static_cast<std::size_t>(activeStride) * height, 0);
+
+    heatWidth = (width + HEAT_CELL_SIZE - 1) / HEAT_CELL_SIZE;
+    heatHeight = (height + HEAT_CELL_SIZE - 1) / HEAT_CELL_SIZE;
+    heat.assign(static_cast<std::size_t>(heatWidth) * heatHeight, 0.0f);
+    heatScratch.assign(heat.size(), 0.0f);
+
+    // Split the grid into fixed-size chunks for dirty-rect tracking
+    chunksX = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunksY = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunks = std::vector<Chunk>(chunksX * chunksY);
+    pixelsFullyDirty = true;
+    for (int cy = 0; cy < chunksY; ++cy)
+    {
+        for (int cx = 0; cx < chunksX; ++cx)
+        {
+            Chunk &chunk = chunks[cy * chunksX + cx];
+            chunk.originX = cx * CHUNK_SIZE;
+            chunk.originY = cy * CHUNK_SIZE;
+        }
+    }
+}
+
+void ParticleWorld::wakeAllChunks()
+{
+    // Called whenever the planes were replaced wholesale
+    rebuildActiveCells();
+    std::fill(idleFrames.begin(), idleFrames.end(), 0);
+    for (auto &chunk : chunks)
+    {
+        chunk.reset();
+        chunk.next.expand(chunk.originX, chunk.originY,
+                          std::min(chunk.originX + CHUNK_SIZE, width) - 1,
+                          std::min(chunk.originY + CHUNK_SIZE, height) - 1);
+    }
+}
+
 void ParticleWorld::clear()
 {
-    for (auto &p : particles)
+    std::fill(materials.begin(), materials.end(), MaterialID::Empty);
+    std::fill(variations.begin(), variations.end(), 0);
+    std::fill(velocities.begin(), velocities.end(), sf::Vector2f(0.0f, 0.0f));
+    std::fill(lifeTimes.begin(), lifeTimes.end(), 0.0f);
+    std::fill(updateStamps.begin(), updateStamps.end(), 0);
+    std::fill(idleFrames.begin(), idleFrames.end(), 0);
+    std::fill(reactionClocks.begin(), reactionClocks.end(), 0.0f);
+    std::fill(activeCells.begin(), activeCells.end(), 0);
+    std::fill(heat.begin(), heat.end(), 0.0f);
+    resetChunks();
+    pixelsFullyDirty = true;
+}
+
+void ParticleWorld::resetChunks()
+{
+    for (auto &chunk : chunks)
+    {
+        chunk.reset();
+    }
+}
+
+void ParticleWorld::markDirty(int x, int y)
+{
+    // Neighbours of a changed cell may now be able to move, so wake the 3x3 block
+    int x0 = std::max(x - 1, 0), x1 = std::min(x + 1, width - 1);
+    int y0 = std::max(y - 1, 0), y1 = std::min(y + 1, height - 1);
+
+    for (int row = y0; row <= y1; ++row)
+        std::fill_n(idleFrames.begin() + computeIndex(x0, row), x1 - x0 + 1, 0);
+
+    for (int cy = y0 / CHUNK_SIZE; cy <= y1 / CHUNK_SIZE; ++cy)
     {
-        p = Particle::createEmpty();
+        for (int cx = x0 / CHUNK_SIZE; cx <= x1 / CHUNK_SIZE; ++cx)
+        {
+            Chunk &chunk = chunks[cy * chunksX + cx];
+            chunk.next.expand(std::max(x0, chunk.originX), std::max(y0, chunk.originY),
+                              std::min(x1, chunk.originX + CHUNK_SIZE - 1),
+                              std::min(y1, chunk.originY + CHUNK_SIZE - 1));
+        }
     }
-    std::fill(pixelBuffer.begin(), pixelBuffer.end(), 0);
+}
+
+void ParticleWorld::setWorkerCount(unsigned int count)
+{
+    if (count == getWorkerCount())
+        return;
+
+    if (count <= 1)
+        threadPool.reset();
+    else
+        threadPool = std::make_unique<ThreadPool>(count);
+}
+
+bool ParticleWorld::takeDirtyPixelRects(std::vector<sf::IntRect> &rects)
+{
+    rects.clear();
+    bool partial = !pixelsFullyDirty;
+    pixelsFullyDirty = false;
+
+    // Union each chunk row into one band: few uploads, still bounded by activity
+    for (int cy = 0; cy < chunksY; ++cy)
+    {
+        DirtyRect band;
+        for (int cx = 0; cx < chunksX; ++cx)
+        {
+            AtomicDirtyRect &pixels = chunks[cy * chunksX + cx].pixels;
+            DirtyRect rect = pixels.load();
+            if (!rect.isEmpty())
+                band.expand(rect.minX, rect.minY, rect.maxX, rect.maxY);
+            pixels.reset();
+        }
+        if (partial && !band.isEmpty())
+            rects.emplace_back(sf::Vector2i(band.minX, band.minY),
+                               sf::Vector2i(band.maxX - band.minX + 1, band.maxY - band.minY + 1));
+    }
+    return partial;
+}
+
+int ParticleWorld::getActiveChunkCount() const
+{
+    return static_cast<int>(std::count_if(chunks.begin(), chunks.end(),
+                                          [](const Chunk &chunk) { return chunk.isActive(); }));
 }
 
 void ParticleWorld::setParticleAt(int x, int y, const Particle &particle)
@@ -43,14 +185,15 @@ void ParticleWorld::setParticleAt(int x, int y, const Particle &particle)
         return;
 
     int idx = computeIndex(x, y);
-    particles[idx] = particle;
+    materials[idx] = particle.id;
+    variations[idx] = particle.variation;
+    velocities[idx] = particle.velocity;
+    lifeTimes[idx] = particle.lifeTime;
+    updateStamps[idx] = particle.hasBeenUpdatedThisFrame ? frameCounter : 0;
+    setActive(x, y, particle.id);
 
-    // Update pixel buffer for rendering
-    int pixelIdx = idx * 4;
-    pixelBuffer[pixelIdx] = particle.color.r;
-    pixelBuffer[pixelIdx + 1] = particle.color.g;
-    pixelBuffer[pixelIdx + 2] = particle.color.b;
-    pixelBuffer[pixelIdx + 3] = particle.color.a;
+    markDirty(x, y);
+    markPixel(x, y);
 }
 
 void ParticleWorld::swapParticles(int x1, int y1, int x2, int y2)
@@ -58,9 +201,20 @@ void ParticleWorld::swapParticles(int x1, int y1, int x2, int y2)
     if (!inBounds(x1, y1) || !inBounds(x2, y2))
         return;
 
-    Particle temp = getParticleAt(x1, y1);
-    setParticleAt(x1, y1, getParticleAt(x2, y2));
-    setParticleAt(x2, y2, temp);
+    int a = computeIndex(x1, y1);
+    int b = computeIndex(x2, y2);
+    std::swap(materials[a], materials[b]);
+    std::swap(variations[a], variations[b]);
+    std::swap(velocities[a], velocities[b]);
+    std::swap(lifeTimes[a], lifeTimes[b]);
+    std::swap(updateStamps[a], updateStamps[b]);
+    setActive(x1, y1, materials[a]);
+    setActive(x2, y2, materials[b]);
+
+    markDirty(x1, y1);
+    markDirty(x2, y2);
+    markPixel(x1, y1);
+    markPixel(x2, y2);
 }
 
 bool ParticleWorld::isInLiquid(int x, int y, int *lx, int *ly) const
@@ -73,8 +227,8 @@ bool ParticleWorld::isInLiquid(int x, int y, int *lx, int *ly) const
             int nx = x + dx, ny = y + dy;
             if (inBounds(nx, ny))
             {
-                const auto &p = getParticleAt(nx, ny);
-                if (p.id == MaterialID::Water || p.id == MaterialID::Oil)
+                MaterialID id = getMaterialAt(nx, ny);
+                if (id == MaterialID::Water || id == MaterialID::Oil)
                 {
                     *lx = nx;
                     *ly = ny;
@@ -86,121 +240,672 @@ bool ParticleWorld::isInLiquid(int x, int y, int *lx, int *ly) const
     return false;
 }
 
-bool ParticleWorld::isInWater(int x, int y, int *lx, int *ly) const
+void ParticleWorld::update(float deltaTime)
 {
-    // Check 8-directional neighbors for water specifically
-    for (int dy = -1; dy <= 1; dy++)
+    // Stamp 0 marks cells that were never updated, so skip it on wrap-around
+    if (++frameCounter == 0)
+        frameCounter++;
+    bool frameCounterEven = (frameCounter % 2) == 0;
+    int ran = frameCounterEven ? 0 : 1;
+
+    // Everything written last frame becomes this frame's work
+    for (auto &chunk : chunks)
     {
-        for (int dx = -1; dx <= 1; dx++)
+        chunk.beginFrame();
+    }
+
+    updateChunks(deltaTime, ran);
+
+    // The calling thread may have finished on any chunk's stream; give it a
+    // known one for whatever it draws before the next frame (brushes etc.)
+    Random::seedStream(frameCounter, ~std::uint64_t(0));
+
+    updateHeat();
+}
+
+void ParticleWorld::updateHeat()
+{
+    // Diffusion stencil with mirrored edges. The inner loop is branch-free
+    // over contiguous rows, so the compiler vectorises it.
+    for (int hy = 0; hy < heatHeight; ++hy)
+    {
+        const float *up = &heat[std::max(hy - 1, 0) * heatWidth];
+        const float *row = &heat[hy * heatWidth];
+        const float *down = &heat[std::min(hy + 1, heatHeight - 1) * heatWidth];
+        float *out = &heatScratch[hy * heatWidth];
+
+        auto cell = [&](int hx, float left, float right) {
+            float mean = (up[hx] + down[hx] + left + right) * 0.25f;
+            return (row[hx] + HEAT_DIFFUSION * (mean - row[hx])) * HEAT_RETAIN;
+        };
+        out[0] = cell(0, row[0], row[std::min(1, heatWidth - 1)]);
+        for (int hx = 1; hx < heatWidth - 1; ++hx)
+            out[hx] = (row[hx] + HEAT_DIFFUSION * ((up[hx] + down[hx] + row[hx - 1] + row[hx + 1]) * 0.25f - row[hx])) * HEAT_RETAIN;
+        if (heatWidth > 1)
+            out[heatWidth - 1] = cell(heatWidth - 1, row[heatWidth - 2], row[heatWidth - 1]);
+    }
+    heat.swap(heatScratch);
+
+    // Phase changes: one pass over each hot heat cell's cells, instead of
+    // every hot particle probing its neighbours
+    const float threshold = std::min(IGNITION_TEMP, BOIL_TEMP);
+    for (int hy = 0; hy < heatHeight; ++hy)
+    {
+        for (int hx = 0; hx < heatWidth; ++hx)
         {
-            int nx = x + dx, ny = y + dy;
-            if (inBounds(nx, ny))
+            float &temperature = heat[hy * heatWidth + hx];
+            if (temperature < threshold)
+                continue;
+
+            int x0 = hx * HEAT_CELL_SIZE, x1 = std::min(x0 + HEAT_CELL_SIZE, width);
+            int y0 = hy * HEAT_CELL_SIZE, y1 = std::min(y0 + HEAT_CELL_SIZE, height);
+            for (int y = y0; y < y1; ++y)
             {
-                const auto &p = getParticleAt(nx, ny);
-                if (p.id == MaterialID::Water)
+                for (int x = x0; x < x1; ++x)
                 {
-                    *lx = nx;
-                    *ly = ny;
-                    return true;
+                    MaterialID id = materials[computeIndex(x, y)];
+                    int ignitionOdds = getMaterial(id).ignitionOdds;
+                    if (ignitionOdds > 0 && temperature >= IGNITION_TEMP)
+                    {
+                        if (!Random::chance(ignitionOdds))
+                            continue;
+                        if (id == MaterialID::Gunpowder)
+                            explode(x, y);
+                        else
+                            setParticleAt(x, y, Particle::create(MaterialID::Fire));
+                    }
+                    else if (id == MaterialID::Water && temperature >= BOIL_TEMP && Random::chance(BOIL_ODDS))
+                    {
+                        setParticleAt(x, y, Particle::create(MaterialID::Steam));
+                        temperature -= BOIL_HEAT;
+                    }
                 }
             }
         }
     }
-    return false;
 }
 
-void ParticleWorld::update(float deltaTime)
+namespace
 {
-    frameCounter++;
-    bool frameCounterEven = (frameCounter % 2) == 0;
-    int ran = frameCounterEven ? 0 : 1;
-
-    // Process from bottom to top to prevent double updates
-    for (int y = height - 1; y >= 0; --y)
+    // Word-at-a-time multiply/rotate mix; not cryptographic, just quick and well spread
+    std::uint64_t hashBytes(std::uint64_t hash, const void *data, std::size_t size)
     {
-        for (int x = ran ? 0 : width - 1; ran ? x < width : x > 0; ran ? ++x : --x)
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        const std::uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+
+        std::size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, bytes + i, 8);
+            hash = (hash ^ (word * multiplier));
+            hash = ((hash << 31) | (hash >> 33)) * 0xBF58476D1CE4E5B9ull;
+        }
+        for (; i < size; ++i)
         {
-            auto &particle = getParticleAt(x, y);
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        }
+        return hash ^ (hash >> 29);
+    }
+}
 
-            if (particle.id == MaterialID::Empty)
-                continue;
+std::uint64_t ParticleWorld::computeHash() const
+{
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    hash = hashBytes(hash, &frameCounter, sizeof(frameCounter));
+    hash = hashBytes(hash, materials.data(), materials.size() * sizeof(MaterialID));
+    hash = hashBytes(hash, variations.data(), variations.size());
+    hash = hashBytes(hash, velocities.data(), velocities.size() * sizeof(sf::Vector2f));
+    hash = hashBytes(hash, lifeTimes.data(), lifeTimes.size() * sizeof(float));
+    hash = hashBytes(hash, heat.data(), heat.size() * sizeof(float));
+    return hash;
+}
+
+void ParticleWorld::updateChunks(float dt, bool leftToRight)
+{
+    // Four-phase checkerboard: chunks sharing a phase are a full chunk apart,
+    // and updates never reach further than CHUNK_MARGIN, so workers can't race.
+    // Without a pool the same phases run on this thread, so the worker count
+    // never changes the outcome. As in a row-by-row sweep, the bottom chunk
+    // row's phases go first and columns are counted from the side the sweep
+    // starts on.
+    static const int phaseOffsets[4][2] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}};
 
-            // Update particle lifetime
-            particle.lifeTime += deltaTime;
+    const std::function<void(std::size_t)> task = [&](std::size_t i) {
+        updateChunk(phaseChunks[i], dt, leftToRight);
+    };
 
-            // Dispatch to material-specific update function
-            switch (particle.id)
+    for (const auto &offset : phaseOffsets)
+    {
+        phaseChunks.clear();
+        for (int cy = chunksY - 1 - offset[1]; cy >= 0; cy -= 2)
+        {
+            for (int cx = offset[0]; cx < chunksX; cx += 2)
             {
-            case MaterialID::Sand:      updateSand(x, y, deltaTime); break;
-            case MaterialID::Water:     updateWater(x, y, deltaTime); break;
-            case MaterialID::Salt:      updateSalt(x, y, deltaTime); break;
-            case MaterialID::Fire:      updateFire(x, y, deltaTime); break;
-            case MaterialID::Smoke:     updateSmoke(x, y, deltaTime); break;
-            case MaterialID::Ember:     updateEmber(x, y, deltaTime); break;
-            case MaterialID::Steam:     updateSteam(x, y, deltaTime); break;
-            case MaterialID::Gunpowder: updateGunpowder(x, y, deltaTime); break;
-            case MaterialID::Oil:       updateOil(x, y, deltaTime); break;
-            case MaterialID::Lava:      updateLava(x, y, deltaTime); break;
-            case MaterialID::Acid:      updateAcid(x, y, deltaTime); break;
-            default: break;
+                int index = cy * chunksX + (leftToRight ? cx : chunksX - 1 - cx);
+                if (chunks[index].isActive())
+                    phaseChunks.push_back(index);
             }
         }
+
+        if (threadPool)
+        {
+            threadPool->parallelFor(phaseChunks.size(), task);
+        }
+        else
+        {
+            for (std::size_t i = 0; i < phaseChunks.size(); ++i)
+                task(i);
+        }
     }
+}
+
+void ParticleWorld::updateChunk(int chunkIndex, float dt, bool leftToRight)
+{
+    const DirtyRect &rect = chunks[chunkIndex].current;
+
+    // Random stream depends only on frame and chunk, not on the worker thread
+    Random::seedStream(frameCounter, static_cast<std::uint64_t>(chunkIndex));
 
-    // Reset frame update flags
-    for (auto &p : particles)
+    std::uint64_t updated = 0;
+
+    for (int y = rect.maxY; y >= rect.minY; --y)
+        updated += updateSpan(y, rect.minX, rect.maxX, dt, leftToRight);
+
+    updatedCellCount.fetch_add(updated, std::memory_order_relaxed);
+}
+
+// A worker writes at most CHUNK_MARGIN cells into a neighbouring chunk, so only
+// into the half of its rows nearer the worker. With words never straddling a
+// half, two workers of one phase never share an activeCells word.
+static_assert(CHUNK_SIZE % 32 == 0 && CHUNK_MARGIN < CHUNK_SIZE / 2, "active words must not be shared between parallel chunks");
+
+std::uint64_t ParticleWorld::updateSpan(int y, int x0, int x1, float dt, bool leftToRight)
+{
+    std::uint64_t updated = 0;
+    const std::uint16_t *row = &activeCells[y * activeStride];
+    int first = x0 / 16, last = x1 / 16;
+
+    for (int i = first; i <= last; ++i)
     {
-        p.hasBeenUpdatedThisFrame = false;
+        int word = leftToRight ? i : first + last - i;
+        int base = word * 16;
+        std::uint32_t inSpan = 0xFFFFu;
+        if (base < x0)
+            inSpan &= 0xFFFFu << (x0 - base);
+        if (base + 15 > x1)
+            inSpan &= 0xFFFFu >> (base + 15 - x1);
+
+        // Re-read the word after each update, which may have moved particles
+        // into or out of cells still ahead in the sweep
+        std::uint32_t bits;
+        while ((bits = row[word] & inSpan) != 0)
+        {
+            int bit = leftToRight ? __builtin_ctz(bits) : 31 - __builtin_clz(bits);
+            updated += updateCell(base + bit, y, dt);
+            inSpan &= leftToRight ? ~((2u << bit) - 1) : (1u << bit) - 1;
+        }
     }
+    return updated;
 }
 
-void ParticleWorld::addParticleCircle(int centerX, int centerY, float radius, MaterialID materialType)
+void ParticleWorld::rebuildActiveCells()
+{
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            setActive(x, y, materials[computeIndex(x, y)]);
+}
+
+bool ParticleWorld::updateCell(int x, int y, float dt)
 {
-    // Place particles in circular area around center point
-    for (int dy = -static_cast<int>(radius); dy <= static_cast<int>(radius); ++dy)
+    int idx = computeIndex(x, y);
+    MaterialID id = materials[idx];
+
+    // Skip empty cells and particles that already moved here this frame,
+    // otherwise anything moving against the sweep would age twice
+    if (id == MaterialID::Empty || updateStamps[idx] == frameCounter)
+        return false;
+
+    // Static materials with a reaction still need their neighbours checked
+    UpdateFn update = updateTable[static_cast<std::size_t>(id)];
+    bool reacts = ReactionTable::reacts(id);
+    if (!update && !reacts)
+        return false;
+
+    const MaterialProps &props = getMaterial(id);
+
+    // A settled cell's update only depends on its 3x3 neighbourhood, and any
+    // write there resets its idle count through markDirty, so once asleep its
+    // update would be a no-op. Materials that react or age every frame never
+    // sleep.
+    if (!props.alwaysActive && !props.ages)
     {
-        for (int dx = -static_cast<int>(radius); dx <= static_cast<int>(radius); ++dx)
+        if (idleFrames[idx] >= SLEEP_FRAMES)
         {
-            int x = centerX + dx;
-            int y = centerY + dy;
+            // Still counts as updated for neighbours that check
+            updateStamps[idx] = frameCounter;
+            return false;
+        }
+        ++idleFrames[idx];
+    }
+
+    if (props.heat > 0.0f)
+        heat[(y / HEAT_CELL_SIZE) * heatWidth + x / HEAT_CELL_SIZE] += props.heat;
+
+    // Only materials that read their lifetime accumulate one
+    if (props.ages)
+        lifeTimes[idx] += dt;
+    updateStamps[idx] = frameCounter;
+
+    if (props.alwaysActive)
+        markDirty(x, y);
+
+    // Animated colours change in place, without a setParticleAt or swap to record them
+    if (props.colorMode != ColorMode::Jitter)
+        markPixel(x, y);
+
+    if (reacts && react(x, y))
+        return true;
+
+    // Dispatch to the material's specialised update
+    if (update)
+        (this->*update)(x, y, dt);
+    return true;
+}
+
+bool ParticleWorld::react(int x, int y)
+{
+    int idx = computeIndex(x, y);
+    MaterialID id = materials[idx];
+    const ReactionRow &row = ReactionTable::row(id);
+
+    // Neighbours with a reaction, and the hazard they add up to this tick
+    const Reaction *partners[8];
+    int partnerX[8], partnerY[8];
+    int partnerCount = 0;
+    float total = 0.0f;
+    for (int dy = -1; dy <= 1; dy++)
+    {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            int nx = x + dx, ny = y + dy;
+            if ((dx == 0 && dy == 0) || !inBounds(nx, ny))
+                continue;
+
+            const Reaction &reaction = row[static_cast<std::size_t>(getMaterialAt(nx, ny))];
+            if (reaction.oneInN == 0)
+                continue;
+            partners[partnerCount] = &reaction;
+            partnerX[partnerCount] = nx;
+            partnerY[partnerCount] = ny;
+            partnerCount++;
+            total += reaction.hazard;
+        }
+    }
+    if (partnerCount == 0)
+        return false;
 
-            // Check distance from center
-            float distance = std::sqrt(static_cast<float>(dx * dx + dy * dy));
-            if (distance <= radius)
+    // Rather than rolling every partner every tick, the cell's clock holds an
+    // exponential waiting time that this tick's hazard is spent against. With
+    // fixed partners that is a geometric countdown firing with each pair's
+    // 1-in-N odds per tick; being memoryless it stays exact as partners come
+    // and go. Random numbers are only drawn when a reaction happens.
+    float &clock = reactionClocks[idx];
+    if (clock <= 0.0f)
+        clock = Random::exponential();
+    float remaining = total;
+    while (partnerCount > 0 && clock <= remaining)
+    {
+        // Partner picked in proportion to its share of the hazard
+        float pick = Random::randFloat(0.0f, total);
+        int i = 0;
+        while (i < partnerCount - 1 && pick >= partners[i]->hazard)
+            pick -= partners[i++]->hazard;
+
+        const Reaction &reaction = *partners[i];
+        int nx = partnerX[i], ny = partnerY[i];
+        if (reaction.heat != 0.0f)
+            heat[(y / HEAT_CELL_SIZE) * heatWidth + x / HEAT_CELL_SIZE] += reaction.heat;
+        if (reaction.neighbourProduct != getMaterialAt(nx, ny))
+            setParticleAt(nx, ny, Particle::create(reaction.neighbourProduct));
+        if (reaction.product != id)
+        {
+            setParticleAt(x, y, Particle::create(reaction.product));
+            clock = 0.0f;
+            return true;
+        }
+
+        // The rest of the tick runs on without the partner that just reacted
+        remaining = (remaining - clock) * (total - reaction.hazard) / total;
+        total -= reaction.hazard;
+        partnerCount--;
+        partners[i] = partners[partnerCount];
+        partnerX[i] = partnerX[partnerCount];
+        partnerY[i] = partnerY[partnerCount];
+        clock = Random::exponential();
+    }
+    clock -= remaining;
+
+    // Partners still waiting keep the cell from sleeping
+    if (partnerCount > 0)
+        markDirty(x, y);
+    return false;
+}
+
+namespace
+{
+    // Largest s with s * s <= v
+    long long isqrt(long long v)
+    {
+        long long s = static_cast<long long>(std::sqrt(static_cast<double>(v)));
+        while (s * s > v)
+            --s;
+        while ((s + 1) * (s + 1) <= v)
+            ++s;
+        return s;
+    }
+
+    // Narrows [lo, hi] to the u with p <= a * u <= q
+    void restrictRange(double a, double p, double q, double &lo, double &hi)
+    {
+        if (a == 0.0)
+        {
+            if (p > 0.0 || q < 0.0)
+                lo = std::numeric_limits<double>::infinity();
+            return;
+        }
+        double u0 = p / a, u1 = q / a;
+        lo = std::max(lo, std::min(u0, u1));
+        hi = std::min(hi, std::max(u0, u1));
+    }
+}
+
+template <typename SpanFn>
+void ParticleWorld::forEachCapsuleSpan(int x0, int y0, int x1, int y1, float radius, SpanFn &&span) const
+{
+    if (radius < 0.0f)
+        return;
+
+    // Integer cells within radius: dx^2 + dy^2 <= floor(radius^2)
+    const long long radius2 = static_cast<long long>(std::floor(static_cast<double>(radius) * radius));
+    const int reach = static_cast<int>(radius);
+    const long long dx = x1 - x0, dy = y1 - y0;
+    const long long length2 = dx * dx + dy * dy;
+    const double bandWidth = radius * std::sqrt(static_cast<double>(length2));
+
+    int top = std::max(std::min(y0, y1) - reach, 0);
+    int bottom = std::min(std::max(y0, y1) + reach, height - 1);
+    for (int y = top; y <= bottom; ++y)
+    {
+        // The capsule is convex, so its row is one span: the union of the
+        // end caps' spans and the swept band's
+        long long left = LLONG_MAX, right = LLONG_MIN;
+        for (int end = 0; end < 2; ++end)
+        {
+            long long cx = end ? x1 : x0, rowDy = y - (end ? y1 : y0);
+            long long rest = radius2 - rowDy * rowDy;
+            if (rest < 0)
+                continue;
+            long long half = isqrt(rest);
+            left = std::min(left, cx - half);
+            right = std::max(right, cx + half);
+        }
+
+        if (length2 > 0)
+        {
+            // u = x - x0: projection onto the segment within [0, length2],
+            // distance from its line within radius
+            long long ry = y - y0;
+            double lo = -std::numeric_limits<double>::infinity();
+            double hi = std::numeric_limits<double>::infinity();
+            restrictRange(static_cast<double>(dx), static_cast<double>(-dy * ry), static_cast<double>(length2 - dy * ry), lo, hi);
+            restrictRange(static_cast<double>(-dy), -bandWidth - dx * ry, bandWidth - dx * ry, lo, hi);
+            if (std::ceil(lo) <= std::floor(hi))
             {
-                // Only place particle if cell is empty
-                if (isEmpty(x, y))
-                {
-                    Particle p = createParticleByType(materialType);
-                    // Add random initial velocity
-                    p.velocity = {Random::randFloat(-0.5f, 0.5f), Random::randFloat(-0.5f, 0.5f)};
-                    setParticleAt(x, y, p);
-                }
+                left = std::min(left, x0 + static_cast<long long>(std::ceil(lo)));
+                right = std::max(right, x0 + static_cast<long long>(std::floor(hi)));
             }
         }
+
+        left = std::max(left, 0LL);
+        right = std::min(right, static_cast<long long>(width - 1));
+        if (left <= right)
+            span(y, static_cast<int>(left), static_cast<int>(right));
     }
 }
 
+void ParticleWorld::markDirtyRect(int x0, int y0, int x1, int y1)
+{
+    x0 = std::max(x0, 0), x1 = std::min(x1, width - 1);
+    y0 = std::max(y0, 0), y1 = std::min(y1, height - 1);
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    for (int row = y0; row <= y1; ++row)
+        std::fill_n(idleFrames.begin() + computeIndex(x0, row), x1 - x0 + 1, 0);
+
+    for (int cy = y0 / CHUNK_SIZE; cy <= y1 / CHUNK_SIZE; ++cy)
+    {
+        for (int cx = x0 / CHUNK_SIZE; cx <= x1 / CHUNK_SIZE; ++cx)
+        {
+            Chunk &chunk = chunks[cy * chunksX + cx];
+            chunk.next.expand(std::max(x0, chunk.originX), std::max(y0, chunk.originY),
+                              std::min(x1, chunk.originX + CHUNK_SIZE - 1),
+                              std::min(y1, chunk.originY + CHUNK_SIZE - 1));
+        }
+    }
+}
+
+void ParticleWorld::markPixelRect(int x0, int y0, int x1, int y1)
+{
+    for (int cy = y0 / CHUNK_SIZE; cy <= y1 / CHUNK_SIZE; ++cy)
+    {
+        for (int cx = x0 / CHUNK_SIZE; cx <= x1 / CHUNK_SIZE; ++cx)
+        {
+            Chunk &chunk = chunks[cy * chunksX + cx];
+            chunk.pixels.expand(std::max(x0, chunk.originX), std::max(y0, chunk.originY),
+                                std::min(x1, chunk.originX + CHUNK_SIZE - 1),
+                                std::min(y1, chunk.originY + CHUNK_SIZE - 1));
+        }
+    }
+}
+
+void ParticleWorld::addParticleStroke(int x0, int y0, int x1, int y1, float radius, MaterialID materialType)
+{
+    forEachCapsuleSpan(x0, y0, x1, y1, radius, [&](int y, int left, int right) {
+        int placedLeft = right + 1, placedRight = left - 1;
+        int idx = computeIndex(left, y);
+        for (int x = left; x <= right; ++x, ++idx)
+        {
+            // Only place particle if cell is empty
+            if (materials[idx] != MaterialID::Empty)
+                continue;
+
+            Particle p = Particle::create(materialType);
+            // Add random initial velocity
+            p.velocity = {Random::randFloat(-0.5f, 0.5f), Random::randFloat(-0.5f, 0.5f)};
+            materials[idx] = p.id;
+            variations[idx] = p.variation;
+            velocities[idx] = p.velocity;
+            lifeTimes[idx] = 0.0f;
+            updateStamps[idx] = 0;
+            setActive(x, y, p.id);
+            placedLeft = std::min(placedLeft, x);
+            placedRight = x;
+        }
+
+        if (placedLeft <= placedRight)
+        {
+            markDirtyRect(placedLeft - 1, y - 1, placedRight + 1, y + 1);
+            markPixelRect(placedLeft, y, placedRight, y);
+        }
+    });
+}
+
+void ParticleWorld::eraseStroke(int x0, int y0, int x1, int y1, float radius)
+{
+    // Each row is one contiguous fill per plane
+    forEachCapsuleSpan(x0, y0, x1, y1, radius, [&](int y, int left, int right) {
+        fillSpan(y, left, right, MaterialID::Empty);
+        markDirtyRect(left - 1, y - 1, right + 1, y + 1);
+        markPixelRect(left, y, right, y);
+    });
+}
+
+void ParticleWorld::addParticleCircle(int centerX, int centerY, float radius, MaterialID materialType)
+{
+    addParticleStroke(centerX, centerY, centerX, centerY, radius, materialType);
+}
+
 void ParticleWorld::eraseCircle(int centerX, int centerY, float radius)
 {
-    // Remove particles in circular area
-    for (int i = -radius; i < radius; ++i)
+    eraseStroke(centerX, centerY, centerX, centerY, radius);
+}
+
+void ParticleWorld::fillSpan(int y, int left, int right, MaterialID materialType)
+{
+    int begin = computeIndex(left, y), end = computeIndex(right, y) + 1;
+    std::fill(materials.begin() + begin, materials.begin() + end, materialType);
+    std::fill(velocities.begin() + begin, velocities.begin() + end, sf::Vector2f(0.0f, 0.0f));
+    std::fill(lifeTimes.begin() + begin, lifeTimes.begin() + end, 0.0f);
+    std::fill(updateStamps.begin() + begin, updateStamps.begin() + end, 0);
+    for (int x = left; x <= right; ++x)
+        setActive(x, y, materialType);
+
+    if (materialType == MaterialID::Empty)
+    {
+        std::fill(variations.begin() + begin, variations.begin() + end, 0);
+        return;
+    }
+    // Spawn variations are drawn per cell, in row order
+    for (int idx = begin; idx < end; ++idx)
+        variations[idx] = Particle::create(materialType).variation;
+}
+
+void ParticleWorld::fillRect(int x0, int y0, int x1, int y1, MaterialID materialType)
+{
+    x0 = std::max(x0, 0), x1 = std::min(x1, width - 1);
+    y0 = std::max(y0, 0), y1 = std::min(y1, height - 1);
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    for (int y = y0; y <= y1; ++y)
+        fillSpan(y, x0, x1, materialType);
+
+    markDirtyRect(x0 - 1, y0 - 1, x1 + 1, y1 + 1);
+    markPixelRect(x0, y0, x1, y1);
+}
+
+void ParticleWorld::fillPolygon(const std::vector<sf::Vector2i> &points, MaterialID materialType)
+{
+    // Edge table: each non-horizontal edge covers the rows whose centres lie in
+    // [top, bottom). Crossings are exact, so shared edges and ties at a cell
+    // centre never fill a cell twice or leave a gap.
+    struct Edge
     {
-        for (int j = -radius; j < radius; ++j)
+        int yStart, yEnd;
+        long long ax, ay, dx, dy;
+        // First cell whose centre is at or right of the crossing with row y
+        int firstCell(int y) const
         {
-            int x = centerX + j;
-            int y = centerY + i;
+            long long num = 2 * ax * dy + (2LL * y + 1 - 2 * ay) * dx - dy, den = 2 * dy;
+            return static_cast<int>(num >= 0 ? (num + den - 1) / den : -(-num / den));
+        }
+    };
+    std::vector<Edge> edges;
+    edges.reserve(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        sf::Vector2i a = points[i], b = points[(i + 1) % points.size()];
+        if (a.y == b.y)
+            continue;
+        if (a.y > b.y)
+            std::swap(a, b);
+
+        Edge edge{std::max(a.y, 0), std::min(b.y, height), a.x, a.y, b.x - a.x, b.y - a.y};
+        if (edge.yStart < edge.yEnd)
+            edges.push_back(edge);
+    }
+    if (edges.empty())
+        return;
+    std::sort(edges.begin(), edges.end(), [](const Edge &l, const Edge &r) { return l.yStart < r.yStart; });
+
+    std::vector<Edge> active;
+    std::vector<int> crossings;
+    std::size_t next = 0;
+    for (int y = edges.front().yStart; next < edges.size() || !active.empty(); ++y)
+    {
+        active.erase(std::remove_if(active.begin(), active.end(), [y](const Edge &edge) { return edge.yEnd <= y; }),
+                     active.end());
+        while (next < edges.size() && edges[next].yStart == y)
+            active.push_back(edges[next++]);
+
+        crossings.clear();
+        for (const Edge &edge : active)
+            crossings.push_back(edge.firstCell(y));
+        std::sort(crossings.begin(), crossings.end());
+
+        // Cells whose centre lies in [enter, exit)
+        for (std::size_t i = 0; i + 1 < crossings.size(); i += 2)
+        {
+            int left = std::max(crossings[i], 0);
+            int right = std::min(crossings[i + 1] - 1, width - 1);
+            if (left > right)
+                continue;
+            fillSpan(y, left, right, materialType);
+            markDirtyRect(left - 1, y - 1, right + 1, y + 1);
+            markPixelRect(left, y, right, y);
+        }
+    }
+}
+
+int ParticleWorld::floodFill(int x, int y, MaterialID materialType)
+{
+    if (!inBounds(x, y))
+        return 0;
+    const MaterialID target = materials[computeIndex(x, y)];
+    if (target == materialType)
+        return 0;
 
-            if (inBounds(x, y))
+    // Scanline fill: each seed grows to a full row span, then seeds one cell
+    // per run of matching cells in the rows above and below
+    int filled = 0;
+    std::vector<sf::Vector2i> seeds{{x, y}};
+    while (!seeds.empty())
+    {
+        sf::Vector2i seed = seeds.back();
+        seeds.pop_back();
+        int row = computeIndex(0, seed.y);
+        if (materials[row + seed.x] != target)
+            continue;
+
+        int left = seed.x, right = seed.x;
+        while (left > 0 && materials[row + left - 1] == target)
+            --left;
+        while (right < width - 1 && materials[row + right + 1] == target)
+            ++right;
+
+        fillSpan(seed.y, left, right, materialType);
+        markDirtyRect(left - 1, seed.y - 1, right + 1, seed.y + 1);
+        markPixelRect(left, seed.y, right, seed.y);
+        filled += right - left + 1;
+
+        for (int ny : {seed.y - 1, seed.y + 1})
+        {
+            if (ny < 0 || ny >= height)
+                continue;
+            int neighbourRow = computeIndex(0, ny);
+            bool inRun = false;
+            for (int nx = left; nx <= right; ++nx)
             {
-                float distance = std::sqrt(i * i + j * j);
-                if (distance <= radius)
-                {
-                    setParticleAt(x, y, Particle::createEmpty());
-                }
+                bool matches = materials[neighbourRow + nx] == target;
+                if (matches && !inRun)
+                    seeds.push_back({nx, ny});
+                inRun = matches;
             }
         }
     }
+    return filled;
 }
 
 std::string ParticleWorld::getNextAvailableFilename(const std::string& baseName) 
@@ -219,126 +924,283 @@ std::string ParticleWorld::getNextAvailableFilename(const std::string& baseName)
 bool ParticleWorld::saveWorld(const std::string& baseFilename) 
 {
     std::string filename = getNextAvailableFilename("worlds/" + baseFilename);
-    
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file for writing: " << filename << std::endl;
-        return false;
-    }
-    
-    try {
-        // Write header: dimensions and frame counter
-        file.write(reinterpret_cast<const char*>(&width), sizeof(width));
-        file.write(reinterpret_cast<const char*>(&height), sizeof(height));
-        file.write(reinterpret_cast<const char*>(&frameCounter), sizeof(frameCounter));
-        
-        // Write all particle data sequentially
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                const auto& particle = getParticleAt(x, y);
-                
-                file.write(reinterpret_cast<const char*>(&particle.id), sizeof(particle.id));
-                file.write(reinterpret_cast<const char*>(&particle.velocity.x), sizeof(particle.velocity.x));
-                file.write(reinterpret_cast<const char*>(&particle.velocity.y), sizeof(particle.velocity.y));
-                file.write(reinterpret_cast<const char*>(&particle.lifeTime), sizeof(particle.lifeTime));
-                file.write(reinterpret_cast<const char*>(&particle.color.r), sizeof(particle.color.r));
-                file.write(reinterpret_cast<const char*>(&particle.color.g), sizeof(particle.color.g));
-                file.write(reinterpret_cast<const char*>(&particle.color.b), sizeof(particle.color.b));
-                file.write(reinterpret_cast<const char*>(&particle.color.a), sizeof(particle.color.a));
-            }
-        }
-        
-        file.close();
-        std::cout << "World saved successfully as: " << filename << std::endl;
-        return true;
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Error saving world: " << e.what() << std::endl;
-        file.close();
+    if (!WorldFile::write(filename, snapshot()))
         return false;
-    }
+
+    std::cout << "World saved successfully as: " << filename << std::endl;
+    return true;
 }
 
 bool ParticleWorld::loadWorld(const std::string& filename) 
 {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file for reading: " << filename << std::endl;
+    WorldSnapshot loaded;
+    if (!WorldFile::read(filename, loaded))
+        return false;
+    return restore(loaded);
+}
+
+WorldSnapshot ParticleWorld::snapshot() const
+{
+    WorldSnapshot result;
+    result.width = width;
+    result.height = height;
+    result.frameCounter = frameCounter;
+    result.materials = materials;
+    result.variations = variations;
+    result.velocities = velocities;
+    result.lifeTimes = lifeTimes;
+    return result;
+}
+
+bool ParticleWorld::restore(const WorldSnapshot& source)
+{
+    if (chunkStore) {
+        std::cerr << "Cannot load a world file into a streamed map" << std::endl;
         return false;
     }
-    
-    try {
-        // Read and verify header dimensions
-        int fileWidth, fileHeight;
-        file.read(reinterpret_cast<char*>(&fileWidth), sizeof(fileWidth));
-        file.read(reinterpret_cast<char*>(&fileHeight), sizeof(fileHeight));
-        
-        if (fileWidth != width || fileHeight != height) {
-            std::cerr << "World dimensions mismatch! File: " << fileWidth << "x" << fileHeight 
-                      << ", Current: " << width << "x" << height << std::endl;
-            file.close();
-            return false;
+    if (source.width != width || source.height != height) {
+        allocate(source.width, source.height);
+    }
+
+    materials = source.materials;
+    variations = source.variations;
+    velocities = source.velocities;
+    lifeTimes = source.lifeTimes;
+    frameCounter = source.frameCounter;
+
+    // Everything may have changed, so every chunk starts the next frame awake
+    std::fill(updateStamps.begin(), updateStamps.end(), 0);
+    std::fill(reactionClocks.begin(), reactionClocks.end(), 0.0f);
+    std::fill(heat.begin(), heat.end(), 0.0f);
+    wakeAllChunks();
+    pixelsFullyDirty = true;
+    return true;
+}
+
+bool ParticleWorld::streamFrom(std::unique_ptr<ChunkStore> store, int residentChunkBudget, int viewWidth, int viewHeight)
+{
+    // Smallest window that keeps a chunk of margin around the view, grown evenly up to the budget
+    int minChunksX = (viewWidth + CHUNK_SIZE - 1) / CHUNK_SIZE + 2;
+    int minChunksY = (viewHeight + CHUNK_SIZE - 1) / CHUNK_SIZE + 2;
+    if (minChunksX * minChunksY > residentChunkBudget) {
+        std::cerr << "Resident chunk budget " << residentChunkBudget << " is below the "
+                  << minChunksX * minChunksY << " chunks the view needs; using that instead" << std::endl;
+    }
+    int windowChunksX = minChunksX;
+    int windowChunksY = minChunksY;
+    while ((windowChunksX + 1) * (windowChunksY + 1) <= residentChunkBudget) {
+        ++windowChunksX;
+        ++windowChunksY;
+    }
+    windowChunksX = std::min(windowChunksX, store->getChunksX());
+    windowChunksY = std::min(windowChunksY, store->getChunksY());
+
+    chunkStore = std::move(store);
+    originChunkX = 0;
+    originChunkY = 0;
+    frameCounter = 0;
+    allocate(windowChunksX * CHUNK_SIZE, windowChunksY * CHUNK_SIZE);
+
+    for (int cy = 0; cy < chunksY; ++cy)
+        for (int cx = 0; cx < chunksX; ++cx)
+            pageIn(cx, cy);
+    wakeAllChunks();
+
+    std::cout << "Streaming " << getMapWidth() << "x" << getMapHeight() << " map through a "
+              << chunksX << "x" << chunksY << " chunk window" << std::endl;
+    return true;
+}
+
+void ParticleWorld::followView(int viewX, int viewY, int viewWidth, int viewHeight)
+{
+    if (!chunkStore)
+        return;
+
+    // Still a chunk of margin on every side that isn't the map edge: nothing to do
+    int originX = getOriginX(), originY = getOriginY();
+    bool fitsX = (originChunkX == 0 || viewX - CHUNK_SIZE >= originX) &&
+                 (originChunkX + chunksX == chunkStore->getChunksX() || viewX + viewWidth + CHUNK_SIZE <= originX + width);
+    bool fitsY = (originChunkY == 0 || viewY - CHUNK_SIZE >= originY) &&
+                 (originChunkY + chunksY == chunkStore->getChunksY() || viewY + viewHeight + CHUNK_SIZE <= originY + height);
+    if (fitsX && fitsY)
+        return;
+
+    int centreX = (viewX + viewWidth / 2) / CHUNK_SIZE;
+    int centreY = (viewY + viewHeight / 2) / CHUNK_SIZE;
+    moveWindow(std::clamp(centreX - chunksX / 2, 0, chunkStore->getChunksX() - chunksX),
+               std::clamp(centreY - chunksY / 2, 0, chunkStore->getChunksY() - chunksY));
+}
+
+void ParticleWorld::flushChunks()
+{
+    if (!chunkStore)
+        return;
+
+    for (int cy = 0; cy < chunksY; ++cy)
+        for (int cx = 0; cx < chunksX; ++cx)
+            pageOut(cx, cy);
+}
+
+namespace
+{
+    template <typename T>
+    void copyChunkCells(const std::vector<T> &from, std::vector<T> &to, int width, int fromX, int fromY, int toX, int toY)
+    {
+        for (int row = 0; row < CHUNK_SIZE; ++row)
+        {
+            std::copy_n(from.begin() + (fromY + row) * width + fromX, CHUNK_SIZE,
+                        to.begin() + (toY + row) * width + toX);
         }
-        
-        file.read(reinterpret_cast<char*>(&frameCounter), sizeof(frameCounter));
-        
-        // Read particle data sequentially
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                Particle particle;
-                
-                file.read(reinterpret_cast<char*>(&particle.id), sizeof(particle.id));
-                file.read(reinterpret_cast<char*>(&particle.velocity.x), sizeof(particle.velocity.x));
-                file.read(reinterpret_cast<char*>(&particle.velocity.y), sizeof(particle.velocity.y));
-                file.read(reinterpret_cast<char*>(&particle.lifeTime), sizeof(particle.lifeTime));
-                file.read(reinterpret_cast<char*>(&particle.color.r), sizeof(particle.color.r));
-                file.read(reinterpret_cast<char*>(&particle.color.g), sizeof(particle.color.g));
-                file.read(reinterpret_cast<char*>(&particle.color.b), sizeof(particle.color.b));
-                file.read(reinterpret_cast<char*>(&particle.color.a), sizeof(particle.color.a));
-                
-                particle.hasBeenUpdatedThisFrame = false;
-                setParticleAt(x, y, particle);
+    }
+}
+
+void ParticleWorld::moveWindow(int newOriginX, int newOriginY)
+{
+    if (newOriginX == originChunkX && newOriginY == originChunkY)
+        return;
+
+    int shiftX = newOriginX - originChunkX;
+    int shiftY = newOriginY - originChunkY;
+    auto keeps = [&](int cx, int cy) {
+        return cx >= 0 && cx < chunksX && cy >= 0 && cy < chunksY;
+    };
+
+    // Chunks that fall out of the window go back to the store
+    for (int cy = 0; cy < chunksY; ++cy)
+        for (int cx = 0; cx < chunksX; ++cx)
+            if (!keeps(cx - shiftX, cy - shiftY))
+                pageOut(cx, cy);
+
+    // Shift the chunks that stay into their new window positions
+    std::vector<MaterialID> newMaterials(materials.size(), MaterialID::Empty);
+    std::vector<std::uint8_t> newVariations(variations.size(), 0);
+    std::vector<sf::Vector2f> newVelocities(velocities.size(), sf::Vector2f(0.0f, 0.0f));
+    std::vector<float> newLifeTimes(lifeTimes.size(), 0.0f);
+    for (int cy = 0; cy < chunksY; ++cy)
+    {
+        for (int cx = 0; cx < chunksX; ++cx)
+        {
+            int oldX = cx + shiftX, oldY = cy + shiftY;
+            if (!keeps(oldX, oldY))
+                continue;
+            int fromX = oldX * CHUNK_SIZE, fromY = oldY * CHUNK_SIZE;
+            int toX = cx * CHUNK_SIZE, toY = cy * CHUNK_SIZE;
+            copyChunkCells(materials, newMaterials, width, fromX, fromY, toX, toY);
+            copyChunkCells(variations, newVariations, width, fromX, fromY, toX, toY);
+            copyChunkCells(velocities, newVelocities, width, fromX, fromY, toX, toY);
+            copyChunkCells(lifeTimes, newLifeTimes, width, fromX, fromY, toX, toY);
+        }
+    }
+    materials.swap(newMaterials);
+    variations.swap(newVariations);
+    velocities.swap(newVelocities);
+    lifeTimes.swap(newLifeTimes);
+    std::fill(updateStamps.begin(), updateStamps.end(), 0);
+
+    // Heat moves with its cells; areas new to the window start cold
+    const int heatShiftX = shiftX * (CHUNK_SIZE / HEAT_CELL_SIZE);
+    const int heatShiftY = shiftY * (CHUNK_SIZE / HEAT_CELL_SIZE);
+    std::fill(heatScratch.begin(), heatScratch.end(), 0.0f);
+    for (int hy = 0; hy < heatHeight; ++hy)
+    {
+        int fromY = hy + heatShiftY;
+        if (fromY < 0 || fromY >= heatHeight)
+            continue;
+        for (int hx = std::max(0, -heatShiftX); hx < std::min(heatWidth, heatWidth - heatShiftX); ++hx)
+            heatScratch[hy * heatWidth + hx] = heat[fromY * heatWidth + hx + heatShiftX];
+    }
+    heat.swap(heatScratch);
+
+    originChunkX = newOriginX;
+    originChunkY = newOriginY;
+
+    // The rest is new to the window
+    for (int cy = 0; cy < chunksY; ++cy)
+        for (int cx = 0; cx < chunksX; ++cx)
+            if (!keeps(cx + shiftX, cy + shiftY))
+                pageIn(cx, cy);
+
+    wakeAllChunks();
+    pixelsFullyDirty = true;
+}
+
+void ParticleWorld::pageIn(int cx, int cy)
+{
+    WorldSnapshot page;
+    bool stored = chunkStore->read(originChunkX + cx, originChunkY + cy, page);
+
+    for (int y = 0; y < CHUNK_SIZE; ++y)
+    {
+        for (int x = 0; x < CHUNK_SIZE; ++x)
+        {
+            int idx = computeIndex(cx * CHUNK_SIZE + x, cy * CHUNK_SIZE + y);
+            if (!stored)
+            {
+                // Never written: created empty on first use
+                materials[idx] = MaterialID::Empty;
+                variations[idx] = 0;
+                velocities[idx] = sf::Vector2f(0.0f, 0.0f);
+                lifeTimes[idx] = 0.0f;
+                continue;
             }
+            int src = y * CHUNK_SIZE + x;
+            materials[idx] = page.materials[src];
+            variations[idx] = page.variations[src];
+            velocities[idx] = page.velocities[src];
+            lifeTimes[idx] = page.lifeTimes[src];
         }
-        
-        file.close();
-        return true;
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Error loading world: " << e.what() << std::endl;
-        file.close();
-        return false;
     }
 }
 
-Particle ParticleWorld::createParticleByType(MaterialID type)
+void ParticleWorld::pageOut(int cx, int cy)
 {
-    switch (type)
+    chunkStore->write(originChunkX + cx, originChunkY + cy, copyChunk(cx, cy));
+}
+
+std::vector<ChunkPage> ParticleWorld::snapshotChunks() const
+{
+    std::vector<ChunkPage> pages;
+    if (!chunkStore)
+        return pages;
+
+    pages.reserve(static_cast<std::size_t>(chunksX) * chunksY);
+    for (int cy = 0; cy < chunksY; ++cy)
+        for (int cx = 0; cx < chunksX; ++cx)
+            pages.push_back({originChunkX + cx, originChunkY + cy, copyChunk(cx, cy)});
+    return pages;
+}
+
+WorldSnapshot ParticleWorld::copyChunk(int cx, int cy) const
+{
+    WorldSnapshot page;
+    page.width = CHUNK_SIZE;
+    page.height = CHUNK_SIZE;
+    page.materials.resize(CHUNK_SIZE * CHUNK_SIZE);
+    page.variations.resize(CHUNK_SIZE * CHUNK_SIZE);
+    page.velocities.resize(CHUNK_SIZE * CHUNK_SIZE);
+    page.lifeTimes.resize(CHUNK_SIZE * CHUNK_SIZE);
+
+    for (int y = 0; y < CHUNK_SIZE; ++y)
     {
-    case MaterialID::Sand:      return Particle::createSand();
-    case MaterialID::Water:     return Particle::createWater();
-    case MaterialID::Salt:      return Particle::createSalt();
-    case MaterialID::Wood:      return Particle::createWood();
-    case MaterialID::Fire:      return Particle::createFire();
-    case MaterialID::Smoke:     return Particle::createSmoke();
-    case MaterialID::Ember:     return Particle::createEmber();
-    case MaterialID::Steam:     return Particle::createSteam();
-    case MaterialID::Gunpowder: return Particle::createGunpowder();
-    case MaterialID::Oil:       return Particle::createOil();
-    case MaterialID::Lava:      return Particle::createLava();
-    case MaterialID::Stone:     return Particle::createStone();
-    case MaterialID::Acid:      return Particle::createAcid();
-    default:                    return Particle::createEmpty();
+        int idx = computeIndex(cx * CHUNK_SIZE, cy * CHUNK_SIZE + y);
+        std::copy_n(materials.begin() + idx, CHUNK_SIZE, page.materials.begin() + y * CHUNK_SIZE);
+        std::copy_n(variations.begin() + idx, CHUNK_SIZE, page.variations.begin() + y * CHUNK_SIZE);
+        std::copy_n(velocities.begin() + idx, CHUNK_SIZE, page.velocities.begin() + y * CHUNK_SIZE);
+        std::copy_n(lifeTimes.begin() + idx, CHUNK_SIZE, page.lifeTimes.begin() + y * CHUNK_SIZE);
     }
+    return page;
 }
 
-void ParticleWorld::updateLiquidMovement(int x, int y, float dt, float horizontalChance, float velocityMultiplier) 
+template <MaterialID M>
+void ParticleWorld::updateLiquid(int x, int y, float dt) 
 {
-    auto& p = getParticleAt(x, y);
+    constexpr const MaterialProps &props = getMaterial(M);
+    constexpr const MotionParams &motion = props.motion;
+    auto p = getParticleAt(x, y);
     
     // Apply gravity with velocity clamping
-    p.velocity.y = std::clamp(p.velocity.y + (GRAVITY * dt), -10.0f, 10.0f);
-    p.velocity.x *= 0.98f; // Apply friction
+    p.velocity.y = std::clamp(p.velocity.y + (GRAVITY * dt * motion.gravityScale), -motion.maxSpeed, motion.maxSpeed);
+    p.velocity.x *= motion.friction; // Apply friction
     
     // Try movement with accumulated velocity
     int targetX = x + static_cast<int>(std::round(p.velocity.x));
@@ -374,13 +1236,13 @@ void ParticleWorld::updateLiquidMovement(int x, int y, float dt, float horizonta
     }
     
     if (canFallLeft) {
-        p.velocity.x = std::clamp(p.velocity.x - velocityMultiplier, -5.0f, 5.0f);
+        p.velocity.x = std::clamp(p.velocity.x - motion.sideImpulse, -motion.maxSideSpeed, motion.maxSideSpeed);
         swapParticles(x, y, x - 1, y + 1);
         return;
     }
     
     if (canFallRight) {
-        p.velocity.x = std::clamp(p.velocity.x + velocityMultiplier, -5.0f, 5.0f);
+        p.velocity.x = std::clamp(p.velocity.x + motion.sideImpulse, -motion.maxSideSpeed, motion.maxSideSpeed);
         swapParticles(x, y, x + 1, y + 1);
         return;
     }
@@ -390,34 +1252,52 @@ void ParticleWorld::updateLiquidMovement(int x, int y, float dt, float horizonta
     bool canFlowRight = inBounds(x + 1, y) && isEmpty(x + 1, y);
     
     if (canFlowLeft || canFlowRight) {
-        p.velocity.x += Random::randFloat(-0.8f, 0.8f);
+        p.velocity.x += Random::randFloat(-motion.jitter, motion.jitter);
         
         if (canFlowLeft && (p.velocity.x < 0 || !canFlowRight)) {
-            if (Random::chance(2)) {
+            if (Random::chance(props.viscosity)) {
                 swapParticles(x, y, x - 1, y);
                 return;
             }
         }
         
         if (canFlowRight && (p.velocity.x > 0 || !canFlowLeft)) {
-            if (Random::chance(2)) {
+            if (Random::chance(props.viscosity)) {
                 swapParticles(x, y, x + 1, y);
                 return;
             }
         }
+        
+        // Lost the roll this frame; stay awake to try again
+        if constexpr (!props.alwaysActive) {
+            markDirty(x, y);
+        }
     }
     
-    // Apply damping when blocked
-    p.velocity.y *= 0.7f;
-    p.velocity.x *= 0.8f;
+    // Apply damping when blocked; a fully enclosed cell comes to rest
+    if (canFlowLeft || canFlowRight) {
+        p.velocity.y *= motion.dampingY;
+        p.velocity.x *= motion.dampingX;
+    } else {
+        p.velocity = {0.0f, 0.0f};
+    }
 }
 
-void ParticleWorld::updateSolidMovement(int x, int y, float dt, bool canDisplaceLiquids) 
+template <MaterialID M>
+void ParticleWorld::updatePowder(int x, int y, float dt) 
 {
-    auto& p = getParticleAt(x, y);
+    constexpr const MaterialProps &props = getMaterial(M);
+    constexpr const MotionParams &motion = props.motion;
+    auto p = getParticleAt(x, y);
+    
+    // Sinks through liquids lighter than itself
+    auto canSinkInto = [](MaterialID id) {
+        const MaterialProps &other = getMaterial(id);
+        return other.state == MaterialState::Liquid && other.density < getMaterial(M).density;
+    };
     
     // Apply gravity acceleration
-    p.velocity.y = std::clamp(p.velocity.y + (GRAVITY * dt), -15.0f, 15.0f);
+    p.velocity.y = std::clamp(p.velocity.y + (GRAVITY * dt * motion.gravityScale), -motion.maxSpeed, motion.maxSpeed);
     
     // Add horizontal randomness when falling fast
     if (p.velocity.y > 2.0f) {
@@ -433,12 +1313,11 @@ void ParticleWorld::updateSolidMovement(int x, int y, float dt, bool canDisplace
     
     // Try direct movement to target position
     if (inBounds(targetX, targetY)) {
-        auto& target = getParticleAt(targetX, targetY);
-        if (target.id == MaterialID::Empty || 
-            (canDisplaceLiquids && (target.id == MaterialID::Water || target.id == MaterialID::Oil) && !target.hasBeenUpdatedThisFrame)) {
+        auto target = getParticleAt(targetX, targetY);
+        if (target.id == MaterialID::Empty || (canSinkInto(target.id) && !target.isUpdated())) {
             
-            if (target.id == MaterialID::Water || target.id == MaterialID::Oil) {
-                target.hasBeenUpdatedThisFrame = true;
+            if (target.id != MaterialID::Empty) {
+                target.markUpdated();
                 
                 // Find nearby empty spot for displaced liquid
                 bool placed = false;
@@ -452,6 +1331,13 @@ void ParticleWorld::updateSolidMovement(int x, int y, float dt, bool canDisplace
                         }
                     }
                 }
+                
+                // The liquid moved out of the way; a swap would duplicate it
+                if (placed) {
+                    setParticleAt(targetX, targetY, p);
+                    setParticleAt(x, y, Particle::create(MaterialID::Empty));
+                    return;
+                }
             }
             
             swapParticles(x, y, targetX, targetY);
@@ -463,14 +1349,13 @@ void ParticleWorld::updateSolidMovement(int x, int y, float dt, bool canDisplace
     for (int step = 1; step <= std::abs(moveY); step++) {
         int testY = y + step;
         if (inBounds(x, testY)) {
-            auto& below = getParticleAt(x, testY);
-            if (below.id == MaterialID::Empty || 
-                (canDisplaceLiquids && (below.id == MaterialID::Water || below.id == MaterialID::Oil) && !below.hasBeenUpdatedThisFrame)) {
+            auto below = getParticleAt(x, testY);
+            if (below.id == MaterialID::Empty || (canSinkInto(below.id) && !below.isUpdated())) {
                 
-                if (below.id == MaterialID::Water || below.id == MaterialID::Oil) {
+                if (below.id != MaterialID::Empty) {
                     // Reduced splash displacement
                     below.velocity = {Random::randFloat(-1.5f, 1.5f), Random::randFloat(-0.5f, -1.5f)};
-                    below.hasBeenUpdatedThisFrame = true;
+                    below.markUpdated();
                     
                     // Find spot for displaced liquid
                     bool placed = false;
@@ -484,6 +1369,12 @@ void ParticleWorld::updateSolidMovement(int x, int y, float dt, bool canDisplace
                             }
                         }
                     }
+                    
+                    if (placed) {
+                        setParticleAt(x, testY, p);
+                        setParticleAt(x, y, Particle::create(MaterialID::Empty));
+                        return;
+                    }
                 }
                 
                 swapParticles(x, y, x, testY);
@@ -501,10 +1392,8 @@ void ParticleWorld::updateSolidMovement(int x, int y, float dt, bool canDisplace
         int diagX = x + (moveX > 0 ? 1 : (moveX < 0 ? -1 : (Random::randBool() ? 1 : -1)));
         
         if (inBounds(diagX, y + 1)) {
-            auto& diag = getParticleAt(diagX, y + 1);
-            if (diag.id == MaterialID::Empty || 
-                (canDisplaceLiquids && (diag.id == MaterialID::Water || diag.id == MaterialID::Oil))) {
-                
+            MaterialID diag = getMaterialAt(diagX, y + 1);
+            if (diag == MaterialID::Empty || canSinkInto(diag)) {
                 p.velocity.x = (diagX > x) ? std::abs(p.velocity.x) : -std::abs(p.velocity.x);
                 swapParticles(x, y, diagX, y + 1);
                 return;
@@ -514,9 +1403,20 @@ void ParticleWorld::updateSolidMovement(int x, int y, float dt, bool canDisplace
     
     // Settle in liquid if surrounded
     int lx, ly;
-    if (isInLiquid(x, y, &lx, &ly) && Random::chance(15)) {
-        swapParticles(x, y, lx, ly);
-        p.velocity.y *= 0.5f;
+    if (isInLiquid(x, y, &lx, &ly)) {
+        if (Random::chance(15)) {
+            swapParticles(x, y, lx, ly);
+            p.velocity.y *= 0.5f;
+        } else {
+            markDirty(x, y);
+        }
+    } else if (isEmpty(x, y + 1) || isEmpty(x - 1, y + 1) || isEmpty(x + 1, y + 1)) {
+        // Still building up speed, or picked the blocked diagonal at random
+        markDirty(x, y);
+    } else {
+        // Resting; drop the leftover velocity so saved worlds stay sparse
+        p.velocity = {0.0f, 0.0f};
+        return;
     }
     
     // Apply friction when not moving
@@ -524,15 +1424,26 @@ void ParticleWorld::updateSolidMovement(int x, int y, float dt, bool canDisplace
     if (std::abs(p.velocity.x) < 0.1f) p.velocity.x = 0.0f;
 }
 
-void ParticleWorld::updateGasMovement(int x, int y, float dt, float buoyancy, float chaosLevel) 
+template <MaterialID M>
+void ParticleWorld::updateGas(int x, int y, float dt) 
 {
-    auto& p = getParticleAt(x, y);
+    constexpr const MaterialProps &props = getMaterial(M);
+    auto p = getParticleAt(x, y);
+    
+    // Gases pass through runny liquids
+    auto canRiseInto = [this](int tx, int ty) {
+        if (!inBounds(tx, ty))
+            return false;
+        const MaterialProps &other = getMaterial(getMaterialAt(tx, ty));
+        return other.state == MaterialState::Empty ||
+               (other.state == MaterialState::Liquid && other.viscosity <= GAS_BUBBLE_MAX_VISCOSITY);
+    };
     
     // Apply buoyancy (negative gravity)
-    p.velocity.y = std::clamp(p.velocity.y - (GRAVITY * dt * buoyancy), -5.0f, 2.0f);
+    p.velocity.y = std::clamp(p.velocity.y - (GRAVITY * dt * props.buoyancy), -5.0f, 2.0f);
     
     // Add chaotic horizontal movement
-    p.velocity.x += Random::randFloat(-chaosLevel, chaosLevel);
+    p.velocity.x += Random::randFloat(-props.motion.jitter, props.motion.jitter);
     p.velocity.x = std::clamp(p.velocity.x, -3.0f, 3.0f);
     
     // Random turbulence
@@ -545,40 +1456,28 @@ void ParticleWorld::updateGasMovement(int x, int y, float dt, float buoyancy, fl
     int targetX = x + static_cast<int>(std::round(p.velocity.x));
     int targetY = y + static_cast<int>(std::round(p.velocity.y));
     
-    // Try direct movement (gases can pass through liquids)
-    if (inBounds(targetX, targetY) && 
-        (isEmpty(targetX, targetY) || 
-         getParticleAt(targetX, targetY).id == MaterialID::Water ||
-         getParticleAt(targetX, targetY).id == MaterialID::Oil)) {
+    // Try direct movement
+    if (canRiseInto(targetX, targetY)) {
         swapParticles(x, y, targetX, targetY);
         return;
     }
     
     // Try upward movement
-    if (inBounds(x, y - 1) && 
-        (isEmpty(x, y - 1) || 
-         getParticleAt(x, y - 1).id == MaterialID::Water ||
-         getParticleAt(x, y - 1).id == MaterialID::Oil)) {
+    if (canRiseInto(x, y - 1)) {
         swapParticles(x, y, x, y - 1);
         return;
     }
     
     // Try horizontal movement
     int direction = (Random::randFloat(-1.0f, 1.0f) > 0) ? 1 : -1;
-    if (inBounds(x + direction, y) && 
-        (isEmpty(x + direction, y) || 
-         getParticleAt(x + direction, y).id == MaterialID::Water ||
-         getParticleAt(x + direction, y).id == MaterialID::Oil)) {
+    if (canRiseInto(x + direction, y)) {
         p.velocity.x += direction * 0.5f;
         swapParticles(x, y, x + direction, y);
         return;
     }
     
     // Try opposite direction
-    if (inBounds(x - direction, y) && 
-        (isEmpty(x - direction, y) || 
-         getParticleAt(x - direction, y).id == MaterialID::Water ||
-         getParticleAt(x - direction, y).id == MaterialID::Oil)) {
+    if (canRiseInto(x - direction, y)) {
         p.velocity.x -= direction * 0.5f;
         swapParticles(x, y, x - direction, y);
         return;
@@ -586,10 +1485,7 @@ void ParticleWorld::updateGasMovement(int x, int y, float dt, float buoyancy, fl
     
     // Try diagonal upward movement
     for (int dx = -1; dx <= 1; dx += 2) {
-        if (inBounds(x + dx, y - 1) && 
-            (isEmpty(x + dx, y - 1) || 
-             getParticleAt(x + dx, y - 1).id == MaterialID::Water ||
-             getParticleAt(x + dx, y - 1).id == MaterialID::Oil)) {
+        if (canRiseInto(x + dx, y - 1)) {
             swapParticles(x, y, x + dx, y - 1);
             return;
         }
@@ -600,181 +1496,95 @@ void ParticleWorld::updateGasMovement(int x, int y, float dt, float buoyancy, fl
     p.velocity.y *= 0.9f;
 }
 
-void ParticleWorld::updateSand(int x, int y, float dt) 
+void ParticleWorld::explode(int x, int y)
 {
-    auto& p = getParticleAt(x, y);
-    if (p.hasBeenUpdatedThisFrame) return;
-    p.hasBeenUpdatedThisFrame = true;
-    
-    // Apply gravity acceleration for realistic falling
-    p.velocity.y = std::clamp(p.velocity.y + (GRAVITY * dt), -10.0f, 10.0f);
-    
-    updateSolidMovement(x, y, dt, true);
-}
-
-void ParticleWorld::updateWater(int x, int y, float dt) 
-{
-    auto& p = getParticleAt(x, y);
-    if (p.hasBeenUpdatedThisFrame) return;
-    p.hasBeenUpdatedThisFrame = true;
-    
-    updateLiquidMovement(x, y, dt, 2.0f, 2.0f);
+    for (int ey = -4; ey <= 4; ey++) {
+        for (int ex = -4; ex <= 4; ex++) {
+            int explosionX = x + ex, explosionY = y + ey;
+            if (inBounds(explosionX, explosionY)) {
+                float distance = std::sqrt(ex * ex + ey * ey);
+                if (distance <= 4.0f && Random::chance(3)) {
+                    setParticleAt(explosionX, explosionY, Particle::create(MaterialID::Fire));
+                }
+            }
+        }
+    }
 }
 
-void ParticleWorld::updateSalt(int x, int y, float dt) 
+template <MaterialID M>
+void ParticleWorld::updateMaterial(int x, int y, float dt)
 {
-    auto& p = getParticleAt(x, y);
-    if (p.hasBeenUpdatedThisFrame) return;
-    p.hasBeenUpdatedThisFrame = true;
-    
-    // Dissolve in nearby liquid
-    int lx, ly;
-    if (isInLiquid(x, y, &lx, &ly) && Random::chance(800)) {
-        setParticleAt(x, y, Particle::createEmpty());
-        return;
+    constexpr MaterialState state = getMaterial(M).state;
+    
+    if constexpr (state == MaterialState::Powder) {
+        updatePowder<M>(x, y, dt);
+    } else if constexpr (state == MaterialState::Liquid) {
+        updateLiquid<M>(x, y, dt);
+    } else if constexpr (state == MaterialState::Gas) {
+        updateGas<M>(x, y, dt);
     }
-    
-    updateSolidMovement(x, y, dt, false);
 }
 
-void ParticleWorld::updateFire(int x, int y, float dt) 
+template <>
+void ParticleWorld::updateMaterial<MaterialID::Fire>(int x, int y, float /*dt*/) 
 {
-    auto& p = getParticleAt(x, y);
-    if (p.hasBeenUpdatedThisFrame) return;
-    p.hasBeenUpdatedThisFrame = true;
+    auto p = getParticleAt(x, y);
     
     // Fire dies after lifetime or randomly
     if (p.lifeTime > 1.5f || (p.lifeTime > 0.3f && Random::chance(150))) {
         // Create byproducts when dying
         if (Random::chance(5)) {
-            setParticleAt(x, y, Particle::createEmber());
+            setParticleAt(x, y, Particle::create(MaterialID::Ember));
         } else if (Random::chance(3)) {
-            setParticleAt(x, y, Particle::createSmoke());
+            setParticleAt(x, y, Particle::create(MaterialID::Smoke));
         } else {
-            setParticleAt(x, y, Particle::createEmpty());
+            setParticleAt(x, y, Particle::create(MaterialID::Empty));
         }
         return;
     }
     
     // Update fire color randomly
     if (Random::chance(20)) {
-        int colorVariant = Random::randInt(0, 3);
-        switch (colorVariant) {
-            case 0: p.color = sf::Color(255, 80, 20, 255); break;
-            case 1: p.color = sf::Color(250, 150, 10, 255); break;
-            case 2: p.color = sf::Color(200, 150, 0, 255); break;
-            case 3: p.color = sf::Color(255, 200, 50, 255); break;
-        }
-    }
-    
-    // Ignite nearby flammable materials
-    for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-            if (dx == 0 && dy == 0) continue;
-            int nx = x + dx, ny = y + dy;
-            if (inBounds(nx, ny)) {
-                auto& neighbor = getParticleAt(nx, ny);
-                if ((neighbor.id == MaterialID::Wood || neighbor.id == MaterialID::Oil || 
-                     neighbor.id == MaterialID::Gunpowder) && Random::chance(100)) {
-                    setParticleAt(nx, ny, Particle::createFire());
-                }
-            }
-        }
-    }
-    
-    // Create steam when touching water
-    int lx, ly;
-    if (isInWater(x, y, &lx, &ly) && Random::chance(5)) {
-        setParticleAt(x, y, Particle::createSteam());
-        setParticleAt(lx, ly, Particle::createSteam());
-        return;
+        p.setVariation(FIRE_FLICKER_VARIATIONS[Random::randInt(0, 3)]);
     }
 }
 
-void ParticleWorld::updateSmoke(int x, int y, float dt) 
+template <>
+void ParticleWorld::updateMaterial<MaterialID::Smoke>(int x, int y, float dt) 
 {
-    auto& p = getParticleAt(x, y);
-    if (p.hasBeenUpdatedThisFrame) return;
-    p.hasBeenUpdatedThisFrame = true;
+    auto p = getParticleAt(x, y);
     
     // Smoke dissipates over time
     if (p.lifeTime > 15.0f) {
-        setParticleAt(x, y, Particle::createEmpty());
+        setParticleAt(x, y, Particle::create(MaterialID::Empty));
         return;
     }
     
     // Fade color based on lifetime
     float lifeFactor = std::clamp((15.0f - p.lifeTime) / 15.0f, 0.1f, 1.0f);
-    p.color.r = static_cast<uint8_t>(lifeFactor * 80);
-    p.color.g = static_cast<uint8_t>(lifeFactor * 70);
-    p.color.b = static_cast<uint8_t>(lifeFactor * 60);
-    p.color.a = static_cast<uint8_t>(lifeFactor * 255);
+    p.setVariation(static_cast<uint8_t>(lifeFactor * 255));
     
-    updateGasMovement(x, y, dt, 0.8f, 1.2f);
+    updateGas<MaterialID::Smoke>(x, y, dt);
 }
 
-void ParticleWorld::updateEmber(int x, int y, float dt) 
+template <>
+void ParticleWorld::updateMaterial<MaterialID::Ember>(int x, int y, float dt) 
 {
-    auto& p = getParticleAt(x, y);
-    if (p.hasBeenUpdatedThisFrame) return;
-    p.hasBeenUpdatedThisFrame = true;
+    auto p = getParticleAt(x, y);
     
     // Embers die quickly
     if (p.lifeTime > 0.2f && Random::chance(100)) {
-        setParticleAt(x, y, Particle::createEmpty());
+        setParticleAt(x, y, Particle::create(MaterialID::Empty));
         return;
     }
     
     // Embers rise with slight buoyancy
-    p.velocity.y = std::clamp(p.velocity.y - (GRAVITY * dt) * 0.2f, -5.0f, 0.0f);
+    p.velocity.y = std::clamp(p.velocity.y - (GRAVITY * dt) * getMaterial(MaterialID::Ember).buoyancy, -5.0f, 0.0f);
     p.velocity.x = std::clamp(p.velocity.x + Random::randFloat(-0.01f, 0.01f), -0.5f, 0.5f);
     
     // Random color variation
     if (Random::chance(static_cast<int>(p.lifeTime * 100.0f + 1)) && Random::chance(200)) {
-        int colorVariant = Random::randInt(0, 3);
-        switch (colorVariant) {
-            case 0: p.color = sf::Color(255, 80, 20, 255); break;
-            case 1: p.color = sf::Color(250, 150, 10, 255); break;
-            case 2: p.color = sf::Color(200, 150, 0, 255); break;
-            case 3: p.color = sf::Color(100, 50, 2, 255); break;
-        }
-        // Update pixel buffer directly for color changes
-        int idx = computeIndex(x, y);
-        int pixelIdx = idx * 4;
-        pixelBuffer[pixelIdx] = p.color.r;
-        pixelBuffer[pixelIdx + 1] = p.color.g;
-        pixelBuffer[pixelIdx + 2] = p.color.b;
-        pixelBuffer[pixelIdx + 3] = p.color.a;
-    }
-    
-    // Embers can still ignite wood
-    for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-            if (dx == 0 && dy == 0) continue;
-            int nx = x + dx, ny = y + dy;
-            if (inBounds(nx, ny) && getParticleAt(nx, ny).id == MaterialID::Wood && Random::chance(150)) {
-                setParticleAt(nx, ny, Particle::createFire());
-            }
-        }
-    }
-    
-    // Create steam when touching water
-    int lx, ly;
-    if (isInWater(x, y, &lx, &ly)) {
-        if (Random::randBool()) {
-            // Generate steam in area above
-            for (int i = -5; i > -5; --i) {
-                for (int j = -5; j < 5; ++j) {
-                    if (inBounds(x + j, y + i) && isEmpty(x + j, y + i)) {
-                        setParticleAt(x + j, y + i, Particle::createSteam());
-                        break;
-                    }
-                }
-            }
-            setParticleAt(lx, ly, Particle::createEmpty());
-            setParticleAt(x, y, Particle::createEmpty());
-            return;
-        }
+        p.setVariation(static_cast<std::uint8_t>(Random::randInt(1, 4)));
     }
     
     // Simple upward movement
@@ -782,216 +1592,67 @@ void ParticleWorld::updateEmber(int x, int y, float dt)
     int vy = static_cast<int>(p.velocity.y);
     
     if (inBounds(x + vx, y + vy) && (isEmpty(x + vx, y + vy) || 
-        getParticleAt(x + vx, y + vy).id == MaterialID::Water ||
-        getParticleAt(x + vx, y + vy).id == MaterialID::Smoke)) {
+        getMaterialAt(x + vx, y + vy) == MaterialID::Water ||
+        getMaterialAt(x + vx, y + vy) == MaterialID::Smoke)) {
         swapParticles(x, y, x + vx, y + vy);
     }
     else if (inBounds(x, y - 1) && (isEmpty(x, y - 1) || 
-             getParticleAt(x, y - 1).id == MaterialID::Water ||
-             getParticleAt(x, y - 1).id == MaterialID::Smoke)) {
+             getMaterialAt(x, y - 1) == MaterialID::Water ||
+             getMaterialAt(x, y - 1) == MaterialID::Smoke)) {
         swapParticles(x, y, x, y - 1);
     }
 }
 
-void ParticleWorld::updateSteam(int x, int y, float dt) 
+template <>
+void ParticleWorld::updateMaterial<MaterialID::Steam>(int x, int y, float dt) 
 {
-    auto& p = getParticleAt(x, y);
-    if (p.hasBeenUpdatedThisFrame) return;
-    p.hasBeenUpdatedThisFrame = true;
+    auto p = getParticleAt(x, y);
     
     // Steam dissipates over time
     if (p.lifeTime > 12.0f) {
-        setParticleAt(x, y, Particle::createEmpty());
+        setParticleAt(x, y, Particle::create(MaterialID::Empty));
         return;
     }
     
     // Fade transparency based on lifetime
     float lifeFactor = std::clamp((12.0f - p.lifeTime) / 12.0f, 0.1f, 1.0f);
-    p.color.a = static_cast<uint8_t>(lifeFactor * 255 * 0.8f);
-    
-    updateGasMovement(x, y, dt, 1.0f, 1.8f);
+    p.setVariation(static_cast<uint8_t>(lifeFactor * 255));
     
-    // Condense back to water when cooled
+    // Condense back to water when cooled (before moving, so the check
+    // still refers to this particle rather than whatever swapped in)
     if (p.lifeTime > 8.0f && Random::chance(200)) {
-        setParticleAt(x, y, Particle::createWater());
+        setParticleAt(x, y, Particle::create(MaterialID::Water));
         return;
     }
-}
-
-void ParticleWorld::updateGunpowder(int x, int y, float dt) 
-{
-    auto& p = getParticleAt(x, y);
-    if (p.hasBeenUpdatedThisFrame) return;
-    p.hasBeenUpdatedThisFrame = true;
-    
-    // Check for nearby fire to trigger explosion
-    for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-            if (dx == 0 && dy == 0) continue;
-            int nx = x + dx, ny = y + dy;
-            if (inBounds(nx, ny) && getParticleAt(nx, ny).id == MaterialID::Fire) {
-                // Create explosion in radius
-                for (int ey = -4; ey <= 4; ey++) {
-                    for (int ex = -4; ex <= 4; ex++) {
-                        int explosionX = x + ex, explosionY = y + ey;
-                        if (inBounds(explosionX, explosionY)) {
-                            float distance = std::sqrt(ex * ex + ey * ey);
-                            if (distance <= 4.0f && Random::chance(3)) {
-                                setParticleAt(explosionX, explosionY, Particle::createFire());
-                            }
-                        }
-                    }
-                }
-                return;
-            }
-        }
-    }
     
-    updateSolidMovement(x, y, dt, true);
+    updateGas<MaterialID::Steam>(x, y, dt);
 }
 
-void ParticleWorld::updateOil(int x, int y, float dt) 
+template <>
+void ParticleWorld::updateMaterial<MaterialID::Lava>(int x, int y, float dt) 
 {
-    auto& p = getParticleAt(x, y);
-    if (p.hasBeenUpdatedThisFrame) return;
-    p.hasBeenUpdatedThisFrame = true;
-    
-    // Check for fire ignition
-    for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-            if (dx == 0 && dy == 0) continue;
-            int nx = x + dx, ny = y + dy;
-            if (inBounds(nx, ny) && getParticleAt(nx, ny).id == MaterialID::Fire && Random::chance(30)) {
-                setParticleAt(x, y, Particle::createFire());
-                return;
-            }
-        }
-    }
-    
-    // Oil flows like thick liquid
-    updateLiquidMovement(x, y, dt, 4.0f, 1.5f);
-}
-
-void ParticleWorld::updateLava(int x, int y, float dt) 
-{
-    auto& p = getParticleAt(x, y);
-    if (p.hasBeenUpdatedThisFrame) return;
-    p.hasBeenUpdatedThisFrame = true;
-    
-    // Apply gravity with slight reduction for viscosity
-    p.velocity.y = std::clamp(p.velocity.y + (GRAVITY * dt * 0.85f), -8.0f, 8.0f);
-    p.velocity.x *= 0.95f;
-    
-    // Ignite nearby flammable materials
-    for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-            if (dx == 0 && dy == 0) continue;
-            int nx = x + dx, ny = y + dy;
-            if (inBounds(nx, ny)) {
-                auto& neighbor = getParticleAt(nx, ny);
-                if ((neighbor.id == MaterialID::Wood || neighbor.id == MaterialID::Oil || neighbor.id == MaterialID::Gunpowder) && Random::chance(80)) {
-                    setParticleAt(nx, ny, Particle::createFire());
-                }
-                else if (neighbor.id == MaterialID::Water && Random::chance(15)) {
-                    setParticleAt(nx, ny, Particle::createSteam());
-                }
-            }
-        }
-    }
-    
-    // Movement with accumulated velocity
-    int targetX = x + static_cast<int>(std::round(p.velocity.x));
-    int targetY = y + static_cast<int>(std::round(p.velocity.y));
-    
-    if (inBounds(targetX, targetY) && isEmpty(targetX, targetY)) {
-        swapParticles(x, y, targetX, targetY);
-        return;
-    }
-    
-    // Direct downward fall
-    if (inBounds(x, y + 1) && isEmpty(x, y + 1)) {
-        swapParticles(x, y, x, y + 1);
-        return;
-    }
-    
-    // Diagonal fall
-    bool canFallLeft = inBounds(x - 1, y + 1) && isEmpty(x - 1, y + 1);
-    bool canFallRight = inBounds(x + 1, y + 1) && isEmpty(x + 1, y + 1);
-    
-    if (canFallLeft && canFallRight) {
-        if (std::abs(p.velocity.x) > 0.1f) {
-            if (p.velocity.x < 0) {
-                swapParticles(x, y, x - 1, y + 1);
-            } else {
-                swapParticles(x, y, x + 1, y + 1);
-            }
-        } else {
-            swapParticles(x, y, Random::randBool() ? x - 1 : x + 1, y + 1);
-        }
-        return;
-    }
-    
-    if (canFallLeft) {
-        p.velocity.x = std::clamp(p.velocity.x - 0.8f, -4.0f, 4.0f);
-        swapParticles(x, y, x - 1, y + 1);
+    // Its heat ignites and boils its surroundings through the temperature
+    // field; once that has drained away (into boiling water, say) it sets
+    if (getHeatAt(x, y) < LAVA_SOLIDIFY_TEMP && Random::chance(LAVA_SOLIDIFY_ODDS)) {
+        setParticleAt(x, y, Particle::create(MaterialID::Stone));
         return;
     }
     
-    if (canFallRight) {
-        p.velocity.x = std::clamp(p.velocity.x + 0.8f, -4.0f, 4.0f);
-        swapParticles(x, y, x + 1, y + 1);
-        return;
-    }
-    
-    // Horizontal flow (slower than water)
-    bool canFlowLeft = inBounds(x - 1, y) && isEmpty(x - 1, y);
-    bool canFlowRight = inBounds(x + 1, y) && isEmpty(x + 1, y);
-    
-    if (canFlowLeft || canFlowRight) {
-        p.velocity.x += Random::randFloat(-0.3f, 0.3f);
-        
-        if (canFlowLeft && (p.velocity.x < 0 || !canFlowRight)) {
-            if (Random::chance(5)) {
-                swapParticles(x, y, x - 1, y);
-                return;
-            }
-        }
-        
-        if (canFlowRight && (p.velocity.x > 0 || !canFlowLeft)) {
-            if (Random::chance(5)) {
-                swapParticles(x, y, x + 1, y);
-                return;
-            }
-        }
-    }
-    
-    // Apply damping when blocked
-    p.velocity.y *= 0.8f;
-    p.velocity.x *= 0.85f;
+    // Flows like a slow, heavy liquid
+    updateLiquid<MaterialID::Lava>(x, y, dt);
 }
 
-void ParticleWorld::updateAcid(int x, int y, float dt) 
+template <std::size_t... I>
+constexpr std::array<ParticleWorld::UpdateFn, MATERIAL_COUNT> ParticleWorld::makeUpdateTable(std::index_sequence<I...>)
 {
-    auto& p = getParticleAt(x, y);
-    if (p.hasBeenUpdatedThisFrame) return;
-    p.hasBeenUpdatedThisFrame = true;
-    
-    // Dissolve nearby materials (except stone and acid)
-    for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-            if (dx == 0 && dy == 0) continue;
-            int nx = x + dx, ny = y + dy;
-            if (inBounds(nx, ny)) {
-                auto& neighbor = getParticleAt(nx, ny);
-                if (neighbor.id != MaterialID::Empty && neighbor.id != MaterialID::Acid && 
-                    neighbor.id != MaterialID::Stone && Random::chance(300)) {
-                    setParticleAt(nx, ny, Particle::createEmpty());
-                }
-            }
-        }
-    }
-    
-    updateLiquidMovement(x, y, dt, 3.0f, 1.3f);
+    // Static materials with nothing to age or react have no update at all
+    return {{(getMaterial(static_cast<MaterialID>(I)).state == MaterialState::Empty ||
+              (getMaterial(static_cast<MaterialID>(I)).state == MaterialState::Static && !getMaterial(static_cast<MaterialID>(I)).alwaysActive)
+                  ? nullptr
+                  : &ParticleWorld::updateMaterial<static_cast<MaterialID>(I)>)...}};
 }
 
-} // namespace SandSim
\ No newline at end of file
+const std::array<ParticleWorld::UpdateFn, MATERIAL_COUNT> ParticleWorld::updateTable =
+    ParticleWorld::makeUpdateTable(std::make_index_sequence<MATERIAL_COUNT>{});
+
+} // namespace SandSim
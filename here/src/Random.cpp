@@ -1,7 +1,40 @@
 #include "Random.hpp"
+#include <random>
 
 namespace SandSim {
-    std::random_device Random::rd{};
-    std::mt19937 Random::gen{};
-    bool Random::initialized = false;
-}
\ No newline at end of file
+    namespace {
+        std::uint64_t splitMix64(std::uint64_t& x) {
+            std::uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+    }
+
+    void Random::seedState(std::uint64_t seed) {
+        // splitmix64 expansion never yields the all-zero xoshiro state
+        for (auto& word : state.s) {
+            word = splitMix64(seed);
+        }
+        state.bits = 0;
+        state.bitsLeft = 0;
+        state.initialized = true;
+    }
+
+    void Random::seedFromEntropy() {
+        std::random_device rd;
+        seedState((static_cast<std::uint64_t>(rd()) << 32) | rd());
+    }
+
+    void Random::setSeed(std::uint64_t seed) {
+        baseSeed = seed;
+        seedState(seed);
+    }
+
+    void Random::seedStream(std::uint64_t a, std::uint64_t b) {
+        std::uint64_t x = baseSeed;
+        std::uint64_t mixed = splitMix64(x) ^ a;
+        mixed = splitMix64(mixed) ^ b;
+        seedState(splitMix64(mixed));
+    }
+}
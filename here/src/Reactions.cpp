@@ -0,0 +1,92 @@
+#include "Reactions.hpp"
+#include "Materials.hpp"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace SandSim {
+    namespace {
+        bool findMaterial(const std::string& name, MaterialID& id) {
+            for (std::size_t i = 0; i < MATERIAL_COUNT; ++i) {
+                if (name == MATERIAL_TABLE[i].name) {
+                    id = static_cast<MaterialID>(i);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Hazard whose exponential waiting time fires with probability 1/oneInN
+        // per tick. Certain reactions get more than Random::exponential can
+        // return, so they always fire.
+        float hazardFor(int oneInN) {
+            return oneInN <= 1 ? 17.0f : static_cast<float>(-std::log1p(-1.0 / oneInN));
+        }
+    }
+
+    ReactionTable::Table ReactionTable::makeDefaults() {
+        Table defaults;
+        auto add = [&](MaterialID material, MaterialID neighbour, int oneInN, MaterialID product, MaterialID neighbourProduct) {
+            defaults.rows[static_cast<std::size_t>(material)][static_cast<std::size_t>(neighbour)] =
+                Reaction{oneInN, product, neighbourProduct, 0.0f, hazardFor(oneInN)};
+            defaults.reactive[static_cast<std::size_t>(material)] = true;
+        };
+
+        // Acid eats everything but stone
+        for (std::size_t i = 0; i < MATERIAL_COUNT; ++i) {
+            MaterialID neighbour = static_cast<MaterialID>(i);
+            if (neighbour != MaterialID::Empty && neighbour != MaterialID::Acid && neighbour != MaterialID::Stone) {
+                add(MaterialID::Acid, neighbour, 300, MaterialID::Acid, MaterialID::Empty);
+            }
+        }
+        // Fire and embers quench on contact with water
+        add(MaterialID::Fire, MaterialID::Water, 20, MaterialID::Steam, MaterialID::Steam);
+        add(MaterialID::Ember, MaterialID::Water, 4, MaterialID::Empty, MaterialID::Empty);
+        // Salt dissolves in liquid
+        add(MaterialID::Salt, MaterialID::Water, 3200, MaterialID::Empty, MaterialID::Water);
+        add(MaterialID::Salt, MaterialID::Oil, 3200, MaterialID::Empty, MaterialID::Oil);
+        return defaults;
+    }
+
+    bool ReactionTable::load(const std::string& filename) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open reactions: " << filename << std::endl;
+            return false;
+        }
+
+        Table loaded;
+        std::string line;
+        for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
+            std::size_t comment = line.find('#');
+            if (comment != std::string::npos) {
+                line.erase(comment);
+            }
+
+            std::istringstream fields(line);
+            std::string material, neighbour, product, neighbourProduct;
+            if (!(fields >> material)) {
+                continue;
+            }
+
+            Reaction reaction;
+            MaterialID materialId, neighbourId;
+            if (!(fields >> neighbour >> reaction.oneInN >> product >> neighbourProduct) ||
+                !findMaterial(material, materialId) || !findMaterial(neighbour, neighbourId) ||
+                !findMaterial(product, reaction.product) || !findMaterial(neighbourProduct, reaction.neighbourProduct) ||
+                reaction.oneInN < 1) {
+                std::cerr << "Bad reaction at " << filename << ":" << lineNumber << std::endl;
+                return false;
+            }
+            fields >> reaction.heat;
+            reaction.hazard = hazardFor(reaction.oneInN);
+
+            loaded.rows[static_cast<std::size_t>(materialId)][static_cast<std::size_t>(neighbourId)] = reaction;
+            loaded.reactive[static_cast<std::size_t>(materialId)] = true;
+        }
+
+        table = loaded;
+        return true;
+    }
+}
@@ -1,11 +1,13 @@
 #include "Renderer.hpp"
+#include <algorithm>
 #include <iostream>
 
 namespace SandSim {
 
-Renderer::Renderer() : usePostProcessing(false), 
-                       renderTexture(sf::Vector2u(TEXTURE_WIDTH, TEXTURE_HEIGHT)),
-                       particleSprite(particleTexture) {
+Renderer::Renderer() : particleSprite(particleTexture), usePostProcessing(false), useIndexedColors(false),
+                       viewRect({0, 0}, {static_cast<int>(TEXTURE_WIDTH), static_cast<int>(TEXTURE_HEIGHT)}),
+                       sceneTexture(&particleTexture), sceneRect(viewRect),
+                       textureStale(true), uploadedFrame(0) {
     
     // Create texture for particle data with proper settings
     particleTexture = sf::Texture(sf::Vector2u(TEXTURE_WIDTH, TEXTURE_HEIGHT));
@@ -14,15 +16,61 @@ Renderer::Renderer() : usePostProcessing(false),
     particleTexture.setRepeated(false);
     particleTexture.setSmooth(false); // Pixel art style - no smoothing
     
-    // Apply same settings to renderTexture used for post-processing
-    const_cast<sf::Texture&>(renderTexture.getTexture()).setRepeated(false);
-    const_cast<sf::Texture&>(renderTexture.getTexture()).setSmooth(false);
-    
     // Set texture to sprite
     particleSprite.setTexture(particleTexture);
     
     // Initialize shaders
     setupShaders();
+    setupPalette();
+}
+
+void Renderer::setupPalette() {
+    static_assert(sizeof(sf::Color) == 4, "staged texels must be tightly packed RGBA");
+    
+    // Every (material, variation) colour, one row per material
+    colorTable.resize(MATERIAL_COUNT * 256);
+    for (std::size_t id = 0; id < MATERIAL_COUNT; ++id) {
+        for (int variation = 0; variation < 256; ++variation) {
+            colorTable[id * 256 + variation] = materialColor(static_cast<MaterialID>(id), static_cast<std::uint8_t>(variation));
+        }
+    }
+    
+    const std::string paletteVertexShader = R"(
+        #version 120
+        void main() {
+            gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+            gl_TexCoord[0] = gl_MultiTexCoord0;
+        }
+    )";
+    
+    // Texture coordinates are world cell coordinates; each cell texel holds
+    // two cells as (material, variation, material, variation)
+    const std::string paletteFragmentShader = R"(
+        #version 120
+        uniform sampler2D cells;
+        uniform sampler2D palette;
+        uniform vec2 cellsSize;
+        uniform float materialCount;
+        
+        void main() {
+            vec2 cell = floor(gl_TexCoord[0].xy);
+            vec4 pair = texture2D(cells, vec2(floor(cell.x * 0.5) + 0.5, cell.y + 0.5) / cellsSize);
+            vec2 entry = mod(cell.x, 2.0) < 0.5 ? pair.rg : pair.ba;
+            gl_FragColor = texture2D(palette, vec2((entry.y * 255.0 + 0.5) / 256.0,
+                                                   (entry.x * 255.0 + 0.5) / materialCount));
+        }
+    )";
+    
+    if (!sf::Shader::isAvailable() ||
+        !paletteShader.loadFromMemory(paletteVertexShader, paletteFragmentShader) ||
+        !paletteTexture.resize({256, static_cast<unsigned int>(MATERIAL_COUNT)})) {
+        std::cerr << "Warning: Could not load palette shader. Colouring cells on the CPU." << std::endl;
+        return;
+    }
+    paletteTexture.update(reinterpret_cast<const std::uint8_t*>(colorTable.data()));
+    paletteShader.setUniform("palette", paletteTexture);
+    paletteShader.setUniform("materialCount", static_cast<float>(MATERIAL_COUNT));
+    useIndexedColors = true;
 }
 
 void Renderer::setupShaders() {
@@ -144,14 +192,142 @@ void Renderer::setupShaders() {
     }
 }
 
-void Renderer::updateTexture(const ParticleWorld& world) {
-    // Update texture from particle world pixel buffer
-    particleTexture.update(world.getPixelBuffer());
+void Renderer::updateTexture(int width, int height, const MaterialID* materials, const std::uint8_t* variations, bool partial) {
+    // Worlds loaded from files or streamed windows can be any size
+    sf::Vector2u worldSize(width, height);
+    sf::Texture& target = useIndexedColors ? cellTexture : particleTexture;
+    sf::Vector2u targetSize(useIndexedColors ? (worldSize.x + 1) / 2 : worldSize.x, worldSize.y);
+    if (target.getSize() != targetSize) {
+        target = sf::Texture(targetSize);
+        target.setRepeated(false);
+        target.setSmooth(false);
+        textureStale = true;
+    }
+    
+    partial = partial && !textureStale;
+    
+    std::size_t dirtyCells = 0;
+    for (const auto& rect : dirtyRects) {
+        dirtyCells += static_cast<std::size_t>(rect.size.x) * rect.size.y;
+    }
+    
+    if (!partial || dirtyCells > FULL_UPLOAD_FRACTION * worldSize.x * worldSize.y) {
+        uploadRegion(width, materials, variations, sf::IntRect({0, 0}, sf::Vector2i(worldSize)));
+        textureStale = false;
+        return;
+    }
+    
+    // Upload only the regions that changed
+    for (const auto& rect : dirtyRects) {
+        uploadRegion(width, materials, variations, rect);
+    }
+}
+
+void Renderer::uploadRegion(int width, const MaterialID* materials, const std::uint8_t* variations, const sf::IntRect& rect) {
+    if (useIndexedColors) {
+        // Two cells per texel, so widen the region to whole texels; the
+        // padding cell past an odd world width stays (Empty, 0)
+        int firstTexel = rect.position.x / 2;
+        int lastTexel = (rect.position.x + rect.size.x + 1) / 2;
+        sf::Vector2u size(lastTexel - firstTexel, rect.size.y);
+        uploadBuffer.resize(static_cast<std::size_t>(size.x) * size.y);
+        
+        for (unsigned int row = 0; row < size.y; ++row) {
+            std::size_t rowStart = static_cast<std::size_t>(rect.position.y + row) * width;
+            sf::Color* out = uploadBuffer.data() + static_cast<std::size_t>(row) * size.x;
+            for (unsigned int t = 0; t < size.x; ++t) {
+                int x = (firstTexel + t) * 2;
+                std::size_t i = rowStart + x;
+                out[t] = x + 1 < width
+                    ? sf::Color(static_cast<std::uint8_t>(materials[i]), variations[i],
+                                static_cast<std::uint8_t>(materials[i + 1]), variations[i + 1])
+                    : sf::Color(static_cast<std::uint8_t>(materials[i]), variations[i], 0, 0);
+            }
+        }
+        cellTexture.update(reinterpret_cast<const std::uint8_t*>(uploadBuffer.data()), size,
+                           sf::Vector2u(firstTexel, rect.position.y));
+        return;
+    }
+    
+    // No shader: look every cell up in the flattened palette. The loop is
+    // branch-free so the compiler can unroll it.
+    sf::Vector2u size(rect.size);
+    uploadBuffer.resize(static_cast<std::size_t>(size.x) * size.y);
+    const sf::Color* table = colorTable.data();
+    for (unsigned int row = 0; row < size.y; ++row) {
+        std::size_t rowStart = static_cast<std::size_t>(rect.position.y + row) * width + rect.position.x;
+        sf::Color* out = uploadBuffer.data() + static_cast<std::size_t>(row) * size.x;
+        for (unsigned int x = 0; x < size.x; ++x) {
+            out[x] = table[static_cast<std::size_t>(materials[rowStart + x]) << 8 | variations[rowStart + x]];
+        }
+    }
+    particleTexture.update(reinterpret_cast<const std::uint8_t*>(uploadBuffer.data()), size,
+                           sf::Vector2u(rect.position));
+}
+
+void Renderer::colorizeView() {
+    sf::Vector2u size(viewRect.size);
+    if (colorTarget.getSize() != size && !colorTarget.resize(size)) {
+        std::cerr << "Warning: Could not create palette target. Colouring cells on the CPU." << std::endl;
+        setUseIndexedColors(false);
+        return;
+    }
+    
+    // One quad over the view; its texture coordinates are the cells it covers
+    sf::Vector2f extent(size);
+    sf::Vector2f origin(viewRect.position);
+    sf::Vertex quad[] = {
+        {{0.0f, 0.0f}, sf::Color::White, origin},
+        {{extent.x, 0.0f}, sf::Color::White, {origin.x + extent.x, origin.y}},
+        {{0.0f, extent.y}, sf::Color::White, {origin.x, origin.y + extent.y}},
+        {{extent.x, extent.y}, sf::Color::White, origin + extent},
+    };
+    
+    paletteShader.setUniform("cells", cellTexture);
+    paletteShader.setUniform("cellsSize", sf::Vector2f(cellTexture.getSize()));
+    colorTarget.clear(sf::Color::Transparent);
+    sf::RenderStates states;
+    states.shader = &paletteShader;
+    states.blendMode = sf::BlendNone;
+    colorTarget.draw(quad, 4, sf::PrimitiveType::TriangleStrip, states);
+    colorTarget.display();
+    
+    sceneTexture = &colorTarget.getTexture();
+    sceneRect = sf::IntRect({0, 0}, viewRect.size);
 }
 
-void Renderer::render(sf::RenderWindow& window, const ParticleWorld& world) {
+void Renderer::render(sf::RenderWindow& window, ParticleWorld& world, sf::Vector2i viewOffset) {
     // Update texture with latest particle data
-    updateTexture(world);
+    bool partial = world.takeDirtyPixelRects(dirtyRects);
+    updateTexture(world.getWidth(), world.getHeight(), world.getMaterialBuffer(), world.getVariationBuffer(), partial);
+    uploadedFrame = 0;
+    
+    present(window, {world.getWidth(), world.getHeight()}, viewOffset);
+}
+
+void Renderer::render(sf::RenderWindow& window, const WorldFrame& frame, sf::Vector2i viewOffset) {
+    // The frame's rects only cover changes since the frame published before it;
+    // if that one was never uploaded (replaced before it was consumed), the
+    // rects miss its changes and everything has to go up
+    if (frame.sequence != uploadedFrame || textureStale) {
+        bool partial = frame.previousSequence == uploadedFrame && !frame.fullyDirty;
+        dirtyRects = frame.dirtyRects;
+        updateTexture(frame.width, frame.height, frame.materials.data(), frame.variations.data(), partial);
+        uploadedFrame = frame.sequence;
+    }
+    
+    present(window, {frame.width, frame.height}, viewOffset);
+}
+
+void Renderer::present(sf::RenderWindow& window, sf::Vector2i worldSize, sf::Vector2i viewOffset) {
+    viewRect = sf::IntRect(viewOffset, {std::min(static_cast<int>(TEXTURE_WIDTH), worldSize.x - viewOffset.x),
+                                        std::min(static_cast<int>(TEXTURE_HEIGHT), worldSize.y - viewOffset.y)});
+    
+    sceneTexture = &particleTexture;
+    sceneRect = viewRect;
+    if (useIndexedColors) {
+        colorizeView();
+    }
     
     if (usePostProcessing && blurShader.isAvailable() && bloomShader.isAvailable()) {
         renderWithPostProcessing(window);
@@ -168,6 +344,19 @@ bool Renderer::getUsePostProcessing() const {
     return usePostProcessing;
 }
 
+void Renderer::setUseIndexedColors(bool use) {
+    use = use && paletteShader.getNativeHandle() != 0;
+    if (use != useIndexedColors) {
+        // The other path's texture holds stale contents
+        useIndexedColors = use;
+        textureStale = true;
+    }
+}
+
+bool Renderer::getUseIndexedColors() const {
+    return useIndexedColors;
+}
+
 void Renderer::scaleToWindow(sf::RenderWindow& window) {
     sf::Vector2u windowSize = window.getSize();
     float scaleX = static_cast<float>(windowSize.x) / TEXTURE_WIDTH;
@@ -184,19 +373,61 @@ void Renderer::scaleToWindow(sf::RenderWindow& window) {
     particleSprite.setPosition({offsetX, offsetY});
     
     // CRITICAL: Set exact texture rect to prevent edge bleeding into black bars
-    particleSprite.setTextureRect(sf::IntRect({0, 0}, {static_cast<int>(TEXTURE_WIDTH), static_cast<int>(TEXTURE_HEIGHT)}));
+    particleSprite.setTextureRect(sf::IntRect({0, 0}, viewRect.size));
 }
 
 void Renderer::renderDirect(sf::RenderWindow& window) {
+    particleSprite.setTexture(*sceneTexture);
     scaleToWindow(window);
+    particleSprite.setTextureRect(sceneRect);
     window.draw(particleSprite);
 }
 
+bool Renderer::resizePostProcessing(sf::Vector2u size) {
+    if (size == postProcessSize) {
+        return true;
+    }
+    
+    sf::Vector2u brightSize((size.x + BRIGHT_DOWNSAMPLE - 1) / BRIGHT_DOWNSAMPLE,
+                            (size.y + BRIGHT_DOWNSAMPLE - 1) / BRIGHT_DOWNSAMPLE);
+    sf::Vector2u blurSize((size.x + BLUR_DOWNSAMPLE - 1) / BLUR_DOWNSAMPLE,
+                          (size.y + BLUR_DOWNSAMPLE - 1) / BLUR_DOWNSAMPLE);
+    if (!renderTexture.resize(size) || !brightTexture.resize(brightSize) ||
+        !blurTexture1.resize(blurSize) || !blurTexture2.resize(blurSize)) {
+        std::cerr << "Warning: Could not create post-processing targets. Post-processing disabled." << std::endl;
+        postProcessSize = {};
+        usePostProcessing = false;
+        return false;
+    }
+    
+    // The composite stays pixel-sharp; the reduced targets filter so that
+    // downsampling averages and the bloom upscales smoothly
+    renderTexture.setSmooth(false);
+    renderTexture.setRepeated(false);
+    for (sf::RenderTexture* target : {&brightTexture, &blurTexture1, &blurTexture2}) {
+        target->setSmooth(true);
+        target->setRepeated(false);
+    }
+    postProcessSize = size;
+    return true;
+}
+
 void Renderer::renderWithPostProcessing(sf::RenderWindow& window) {
+    sf::Vector2u size(viewRect.size);
+    if (!resizePostProcessing(size)) {
+        renderDirect(window);
+        return;
+    }
+    sf::Vector2f brightSize(brightTexture.getSize());
+    sf::Vector2f blurSize(blurTexture1.getSize());
+    sf::Vector2f toBright(brightSize.x / size.x, brightSize.y / size.y);
+    sf::Vector2f brightToBlur(blurSize.x / brightSize.x, blurSize.y / brightSize.y);
+    sf::Vector2f blurToFull(size.x / blurSize.x, size.y / blurSize.y);
+    
     // Step 1: Render original to texture with slight enhancement
     renderTexture.clear();
-    sf::Sprite tempSprite(particleTexture);
-    tempSprite.setTextureRect(sf::IntRect({0, 0}, {static_cast<int>(TEXTURE_WIDTH), static_cast<int>(TEXTURE_HEIGHT)}));
+    sf::Sprite tempSprite(*sceneTexture);
+    tempSprite.setTextureRect(sceneRect);
     
     // Apply enhancement if available
     if (enhanceShader.isAvailable()) {
@@ -206,37 +437,27 @@ void Renderer::renderWithPostProcessing(sf::RenderWindow& window) {
     }
     renderTexture.display();
     
-    // Step 2: Extract bright areas for bloom
-    sf::RenderTexture bloomTexture(sf::Vector2u(TEXTURE_WIDTH, TEXTURE_HEIGHT));
-    const_cast<sf::Texture&>(bloomTexture.getTexture()).setRepeated(false);
-    const_cast<sf::Texture&>(bloomTexture.getTexture()).setSmooth(false);
-    
-    bloomTexture.clear(sf::Color::Transparent);
-    sf::Sprite bloomSprite(renderTexture.getTexture());
-    bloomSprite.setTextureRect(sf::IntRect({0, 0}, {static_cast<int>(TEXTURE_WIDTH), static_cast<int>(TEXTURE_HEIGHT)}));
-    bloomTexture.draw(bloomSprite, &bloomShader);
-    bloomTexture.display();
-    
-    // Step 3: Apply multiple blur passes for better bloom spread
-    sf::RenderTexture blurTexture1(sf::Vector2u(TEXTURE_WIDTH, TEXTURE_HEIGHT));
-    sf::RenderTexture blurTexture2(sf::Vector2u(TEXTURE_WIDTH, TEXTURE_HEIGHT));
+    // Step 2: Extract bright areas for bloom at half resolution
+    renderTexture.setSmooth(true);
+    brightTexture.clear(sf::Color::Transparent);
+    sf::Sprite brightSprite(renderTexture.getTexture());
+    brightSprite.setScale(toBright);
+    brightTexture.draw(brightSprite, &bloomShader);
+    brightTexture.display();
+    renderTexture.setSmooth(false);
     
-    const_cast<sf::Texture&>(blurTexture1.getTexture()).setRepeated(false);
-    const_cast<sf::Texture&>(blurTexture1.getTexture()).setSmooth(false);
-    const_cast<sf::Texture&>(blurTexture2.getTexture()).setRepeated(false);
-    const_cast<sf::Texture&>(blurTexture2.getTexture()).setSmooth(false);
-    
-    // First blur pass
+    // Step 3: Apply multiple blur passes at quarter resolution for better bloom spread
     blurTexture1.clear();
-    sf::Sprite blurSprite1(bloomTexture.getTexture());
-    blurSprite1.setTextureRect(sf::IntRect({0, 0}, {static_cast<int>(TEXTURE_WIDTH), static_cast<int>(TEXTURE_HEIGHT)}));
+    sf::Sprite blurSprite1(brightTexture.getTexture());
+    blurSprite1.setScale(brightToBlur);
+    blurShader.setUniform("offset", sf::Vector2f(1.0f / brightSize.x, 1.0f / brightSize.y));
     blurTexture1.draw(blurSprite1, &blurShader);
     blurTexture1.display();
     
     // Second blur pass for smoother bloom
     blurTexture2.clear();
     sf::Sprite blurSprite2(blurTexture1.getTexture());
-    blurSprite2.setTextureRect(sf::IntRect({0, 0}, {static_cast<int>(TEXTURE_WIDTH), static_cast<int>(TEXTURE_HEIGHT)}));
+    blurShader.setUniform("offset", sf::Vector2f(1.0f / blurSize.x, 1.0f / blurSize.y));
     blurTexture2.draw(blurSprite2, &blurShader);
     blurTexture2.display();
     
@@ -244,24 +465,20 @@ void Renderer::renderWithPostProcessing(sf::RenderWindow& window) {
     renderTexture.clear();
     
     // Draw original
-    sf::Sprite originalSprite(particleTexture);
-    originalSprite.setTextureRect(sf::IntRect({0, 0}, {static_cast<int>(TEXTURE_WIDTH), static_cast<int>(TEXTURE_HEIGHT)}));
+    sf::Sprite originalSprite(*sceneTexture);
+    originalSprite.setTextureRect(sceneRect);
     renderTexture.draw(originalSprite);
     
     // Add bloom with additive blending (stronger effect)
     sf::Sprite bloomedSprite(blurTexture2.getTexture());
-    bloomedSprite.setTextureRect(sf::IntRect({0, 0}, {static_cast<int>(TEXTURE_WIDTH), static_cast<int>(TEXTURE_HEIGHT)}));
+    bloomedSprite.setScale(blurToFull);
     sf::RenderStates additiveState;
     additiveState.blendMode = sf::BlendAdd;
     renderTexture.draw(bloomedSprite, additiveState);
     
     // Add a second, softer bloom layer for more glow
-    sf::Sprite softBloomSprite(blurTexture2.getTexture());
-    softBloomSprite.setTextureRect(sf::IntRect({0, 0}, {static_cast<int>(TEXTURE_WIDTH), static_cast<int>(TEXTURE_HEIGHT)}));
-    sf::RenderStates softAdditiveState;
-    softAdditiveState.blendMode = sf::BlendAdd;
-    softBloomSprite.setColor(sf::Color(255, 255, 255, 128)); // 50% opacity for softer effect
-    renderTexture.draw(softBloomSprite, softAdditiveState);
+    bloomedSprite.setColor(sf::Color(255, 255, 255, 128)); // 50% opacity for softer effect
+    renderTexture.draw(bloomedSprite, additiveState);
     
     renderTexture.display();
     
@@ -269,9 +486,6 @@ void Renderer::renderWithPostProcessing(sf::RenderWindow& window) {
     particleSprite.setTexture(renderTexture.getTexture());
     scaleToWindow(window);
     window.draw(particleSprite);
-    
-    // Reset texture to original
-    particleSprite.setTexture(particleTexture);
 }
 
 } // namespace SandSim
\ No newline at end of file
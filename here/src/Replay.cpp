@@ -0,0 +1,214 @@
+#include "Replay.hpp"
+#include "ParticleWorld.hpp"
+#include "Random.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace SandSim {
+
+namespace {
+    const char REPLAY_MAGIC[4] = {'R', 'R', 'P', 'L'};
+    // v2 adds the stroke end point to every command; v3 widens coordinates
+    // from 16 to 32 bits for maps over 32767 cells across
+    const std::uint32_t REPLAY_VERSION = 3;
+
+    template <typename T>
+    void writeValue(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    bool readValue(std::ifstream& file, T& value) {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    // Coordinate as stored by the given replay version
+    bool readCoordinate(std::ifstream& file, std::uint32_t version, std::int32_t& value) {
+        if (version >= 3) {
+            return readValue(file, value);
+        }
+        std::int16_t narrow = 0;
+        bool ok = readValue(file, narrow);
+        value = narrow;
+        return ok;
+    }
+
+    // Bytes one command takes in the given replay version
+    std::uint64_t commandSize(std::uint32_t version) {
+        std::uint64_t coordinates = (version >= 2 ? 4 : 2) * (version >= 3 ? sizeof(std::int32_t) : sizeof(std::int16_t));
+        return sizeof(ReplayCommandType) + sizeof(std::uint32_t) + coordinates + sizeof(float) + sizeof(MaterialID) +
+               sizeof(std::uint8_t);
+    }
+
+    // Bytes between the read position and the end of the file, so counts read
+    // from a damaged file are caught before anything is allocated for them
+    std::uint64_t bytesLeft(std::ifstream& file) {
+        if (!file) return 0;
+        std::streampos position = file.tellg();
+        file.seekg(0, std::ios::end);
+        std::streampos end = file.tellg();
+        file.seekg(position);
+        return end > position ? static_cast<std::uint64_t>(end - position) : 0;
+    }
+}
+
+bool ReplayLog::save(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open replay for writing: " << filename << std::endl;
+        return false;
+    }
+
+    file.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    writeValue(file, REPLAY_VERSION);
+    writeValue(file, seed);
+    writeValue(file, timeStep);
+    writeValue(file, static_cast<std::uint32_t>(worldFile.size()));
+    file.write(worldFile.data(), worldFile.size());
+    writeValue(file, initialHash);
+
+    writeValue(file, static_cast<std::uint32_t>(commands.size()));
+    for (const auto& command : commands) {
+        writeValue(file, command.type);
+        writeValue(file, command.frame);
+        writeValue(file, command.x);
+        writeValue(file, command.y);
+        writeValue(file, command.x2);
+        writeValue(file, command.y2);
+        writeValue(file, command.radius);
+        writeValue(file, command.material);
+        writeValue(file, command.workers);
+    }
+
+    writeValue(file, static_cast<std::uint32_t>(frameHashes.size()));
+    file.write(reinterpret_cast<const char*>(frameHashes.data()), frameHashes.size() * sizeof(std::uint64_t));
+
+    if (!file) {
+        std::cerr << "Error writing replay: " << filename << std::endl;
+        return false;
+    }
+    std::cout << "Replay saved: " << filename << " (" << commands.size() << " commands, "
+              << frameHashes.size() << " frames)" << std::endl;
+    return true;
+}
+
+bool ReplayLog::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open replay for reading: " << filename << std::endl;
+        return false;
+    }
+
+    char magic[4];
+    std::uint32_t version = 0;
+    if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, REPLAY_MAGIC) ||
+        !readValue(file, version) || version < 1 || version > REPLAY_VERSION) {
+        std::cerr << "Not a supported replay file: " << filename << std::endl;
+        return false;
+    }
+
+    std::uint32_t nameLength = 0;
+    if (!readValue(file, seed) || !readValue(file, timeStep) || !readValue(file, nameLength) ||
+        nameLength > bytesLeft(file)) {
+        std::cerr << "Truncated replay header: " << filename << std::endl;
+        return false;
+    }
+    worldFile.assign(nameLength, '\0');
+    file.read(&worldFile[0], nameLength);
+    readValue(file, initialHash);
+
+    std::uint32_t commandCount = 0;
+    if (!readValue(file, commandCount) || commandCount * commandSize(version) > bytesLeft(file)) {
+        std::cerr << "Truncated replay: " << filename << std::endl;
+        return false;
+    }
+    commands.clear();
+    commands.reserve(commandCount);
+    for (std::uint32_t i = 0; i < commandCount && file; ++i) {
+        ReplayCommand command{};
+        readValue(file, command.type);
+        readValue(file, command.frame);
+        readCoordinate(file, version, command.x);
+        readCoordinate(file, version, command.y);
+        if (version >= 2) {
+            readCoordinate(file, version, command.x2);
+            readCoordinate(file, version, command.y2);
+        }
+        readValue(file, command.radius);
+        readValue(file, command.material);
+        readValue(file, command.workers);
+        commands.push_back(command);
+    }
+
+    std::uint32_t frameCount = 0;
+    if (!readValue(file, frameCount) || frameCount * sizeof(std::uint64_t) > bytesLeft(file)) {
+        std::cerr << "Truncated replay: " << filename << std::endl;
+        return false;
+    }
+    frameHashes.assign(frameCount, 0);
+    file.read(reinterpret_cast<char*>(frameHashes.data()), frameCount * sizeof(std::uint64_t));
+
+    if (!file) {
+        std::cerr << "Truncated replay: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ReplayLog::apply(ParticleWorld& world, const ReplayCommand& command) {
+    switch (command.type) {
+        case ReplayCommandType::Brush:
+            world.addParticleCircle(command.x, command.y, command.radius, command.material);
+            break;
+        case ReplayCommandType::Erase:
+            world.eraseCircle(command.x, command.y, command.radius);
+            break;
+        case ReplayCommandType::Clear:
+            world.clear();
+            break;
+        case ReplayCommandType::SetWorkers:
+            world.setWorkerCount(command.workers);
+            break;
+        case ReplayCommandType::Stroke:
+            world.addParticleStroke(command.x, command.y, command.x2, command.y2, command.radius, command.material);
+            break;
+        case ReplayCommandType::EraseStroke:
+            world.eraseStroke(command.x, command.y, command.x2, command.y2, command.radius);
+            break;
+    }
+}
+
+ReplayResult runReplay(const ReplayLog& log) {
+    ReplayResult result;
+
+    ParticleWorld world(TEXTURE_WIDTH, TEXTURE_HEIGHT, log.worldFile);
+    Random::setSeed(log.seed);
+
+    result.expectedHash = log.initialHash;
+    result.actualHash = world.computeHash();
+    if (result.actualHash != result.expectedHash) {
+        result.divergentFrame = 0;
+        return result;
+    }
+
+    std::size_t next = 0;
+    for (std::uint32_t frame = 0; frame < log.getFrameCount(); ++frame) {
+        while (next < log.commands.size() && log.commands[next].frame == frame) {
+            ReplayLog::apply(world, log.commands[next++]);
+        }
+
+        world.update(log.timeStep);
+
+        result.expectedHash = log.frameHashes[frame];
+        result.actualHash = world.computeHash();
+        if (result.actualHash != result.expectedHash) {
+            result.divergentFrame = static_cast<std::int64_t>(frame) + 1;
+            return result;
+        }
+    }
+
+    return result;
+}
+
+} // namespace SandSim
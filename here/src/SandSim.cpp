@@ -1,11 +1,17 @@
 #include "SandSim.hpp"
 #include <cmath>
 #include <algorithm>
+#include <thread>
 
 namespace SandSim {
 
-SandSimApp::SandSimApp() : running(true), simulationRunning(true), frameTime(0.0f), 
-                          hasPreviousMousePos(false), currentState(GameState::MENU) {
+SandSimApp::SandSimApp(const std::string& recordPath, const std::string& mapPath, int chunkBudget, bool simulationThread,
+                       int tickRate)
+                        : currentState(GameState::MENU), running(true), simulationRunning(true), frameTime(0.0f),
+                          tickRate(tickRate), timestep(tickRate), workerCount(std::max(1u, std::thread::hardware_concurrency())),
+                          hasPreviousMousePos(false), recordPath(recordPath),
+                          mapPath(mapPath), chunkBudget(chunkBudget), camera(0, 0), mapSize(0, 0),
+                          useSimulationThread(simulationThread) {
     // Initialize window
     window.create(sf::VideoMode({static_cast<unsigned int>(WINDOW_WIDTH), static_cast<unsigned int>(WINDOW_HEIGHT)}), "Sand Simulation - SFML 3");
     window.setFramerateLimit(60);
@@ -19,6 +25,11 @@ SandSimApp::SandSimApp() : running(true), simulationRunning(true), frameTime(0.0
     
     // Initialize random seed
     Random::setSeed(static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+    
+    // A streamed map skips the level menu
+    if (!mapPath.empty()) {
+        startMap();
+    }
 }
 
 void SandSimApp::run() {
@@ -27,6 +38,8 @@ void SandSimApp::run() {
         update();
         render();
     }
+    simulation.reset();
+    finishRecording();
 }
 
 void SandSimApp::handleEvents() {
@@ -49,6 +62,7 @@ void SandSimApp::handleEvents() {
         if (sf::Mouse::isButtonPressed(sf::Mouse::Button::Left) || sf::Mouse::isButtonPressed(sf::Mouse::Button::Right)) {
             handleMouseHeld();
         }
+        handleCameraKeys();
     }
 }
 
@@ -121,13 +135,92 @@ void SandSimApp::handleGameEvents(const sf::Event& event) {
 void SandSimApp::startGame(const std::string& worldFile) {
     // Initialize world with selected level
     world = std::make_unique<ParticleWorld>(TEXTURE_WIDTH, TEXTURE_HEIGHT, worldFile);
+    world->setWorkerCount(workerCount);
     ui = std::make_unique<UI>(world.get());
     currentState = GameState::PLAYING;
+    camera = sf::Vector2i(0, 0);
+    
+    if (!recordPath.empty()) {
+        // Fresh seed per session, stored so the replay can reuse it
+        recording = std::make_unique<ReplayLog>();
+        recording->seed = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        recording->worldFile = worldFile;
+        recording->timeStep = timestep.getStep();
+        Random::setSeed(recording->seed);
+        recording->initialHash = world->computeHash();
+        recordCommand(ReplayCommandType::SetWorkers);
+    }
     
+    startSimulation();
     std::cout << "Started game with level: " << worldFile << std::endl;
 }
 
+void SandSimApp::startMap() {
+    auto store = std::make_unique<ChunkStore>();
+    if (!store->open(mapPath, DEFAULT_MAP_CHUNKS, DEFAULT_MAP_CHUNKS)) {
+        std::cerr << "Failed to open map: " << mapPath << std::endl;
+        return;
+    }
+    
+    world = std::make_unique<ParticleWorld>(0, 0);
+    world->streamFrom(std::move(store), chunkBudget, TEXTURE_WIDTH, TEXTURE_HEIGHT);
+    world->setWorkerCount(workerCount);
+    ui = std::make_unique<UI>(world.get());
+    currentState = GameState::PLAYING;
+    camera = sf::Vector2i(0, 0);
+    
+    // Brush coordinates are window-relative, so a streamed session can't be replayed
+    if (!recordPath.empty()) {
+        std::cout << "Recording is not supported for streamed maps" << std::endl;
+    }
+    
+    startSimulation();
+    std::cout << "Started map: " << mapPath << std::endl;
+}
+
+void SandSimApp::startSimulation() {
+    mapSize = sf::Vector2i(world->getMapWidth(), world->getMapHeight());
+    timestep.reset();
+    
+    // From here on the world belongs to the simulation thread
+    if (useSimulationThread) {
+        simulation = std::make_unique<SimulationThread>(*world, tickRate, recording.get());
+        simulation->setRunning(simulationRunning);
+    }
+}
+
+void SandSimApp::handleCameraKeys() {
+    if (!world || !window.hasFocus()) return;
+    
+    sf::Vector2i pan(0, 0);
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left)) pan.x -= CAMERA_PAN_SPEED;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right)) pan.x += CAMERA_PAN_SPEED;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up)) pan.y -= CAMERA_PAN_SPEED;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Down)) pan.y += CAMERA_PAN_SPEED;
+    if (pan == sf::Vector2i(0, 0)) return;
+    
+    camera.x = std::clamp(camera.x + pan.x, 0, std::max(0, mapSize.x - static_cast<int>(TEXTURE_WIDTH)));
+    camera.y = std::clamp(camera.y + pan.y, 0, std::max(0, mapSize.y - static_cast<int>(TEXTURE_HEIGHT)));
+    if (simulation) {
+        simulation->post({SimCommand::Type::FollowView, camera.x, camera.y});
+    } else {
+        world->followView(camera.x, camera.y, TEXTURE_WIDTH, TEXTURE_HEIGHT);
+    }
+}
+
+sf::Vector2i SandSimApp::getViewOffset() const {
+    // Camera relative to the resident window, as of the frame being shown
+    if (simulation) {
+        const WorldFrame& frame = simulation->getFrame();
+        return camera - sf::Vector2i(frame.originX, frame.originY);
+    }
+    return world ? camera - sf::Vector2i(world->getOriginX(), world->getOriginY()) : camera;
+}
+
 void SandSimApp::returnToMenu() {
+    simulation.reset();
+    finishRecording();
+    
     // Clean up game objects
     world.reset();
     ui.reset();
@@ -142,11 +235,17 @@ void SandSimApp::handleKeyPress(sf::Keyboard::Key key) {
     switch (key) {            
         case sf::Keyboard::Key::Space:
             simulationRunning = !simulationRunning;
+            if (simulation) {
+                simulation->setRunning(simulationRunning);
+            }
             break;
             
         case sf::Keyboard::Key::R:
-            if (world) {
+            if (simulation) {
+                simulation->post({SimCommand::Type::Clear});
+            } else if (world) {
                 world->clear();
+                recordCommand(ReplayCommandType::Clear);
             }
             break;
             
@@ -154,6 +253,26 @@ void SandSimApp::handleKeyPress(sf::Keyboard::Key key) {
             renderer->setUsePostProcessing(!renderer->getUsePostProcessing());
             break;
             
+        case sf::Keyboard::Key::P:
+            // Toggle between the palette shader and colouring cells on the CPU
+            renderer->setUseIndexedColors(!renderer->getUseIndexedColors());
+            std::cout << "Palette shader: " << (renderer->getUseIndexedColors() ? "on" : "off") << std::endl;
+            break;
+            
+        case sf::Keyboard::Key::T:
+            // Toggle between the serial update and one worker per hardware thread
+            workerCount = workerCount > 1 ? 1 : std::max(1u, std::thread::hardware_concurrency());
+            if (simulation) {
+                SimCommand command{SimCommand::Type::SetWorkers};
+                command.workers = workerCount;
+                simulation->post(command);
+            } else if (world) {
+                world->setWorkerCount(workerCount);
+                recordCommand(ReplayCommandType::SetWorkers);
+            }
+            std::cout << "Simulation threads: " << workerCount << std::endl;
+            break;
+            
         default:
             break;
     }
@@ -162,9 +281,16 @@ void SandSimApp::handleKeyPress(sf::Keyboard::Key key) {
 void SandSimApp::handleMousePress(const sf::Event::MouseButtonPressed& mouseButton) {
     sf::Vector2f worldPos = screenToWorldCoordinates(sf::Vector2f(static_cast<float>(mouseButton.position.x), static_cast<float>(mouseButton.position.y)));
     
-    // Check if UI consumed the click first
-    if (ui && ui->handleClick(worldPos)) {
-        return; // UI handled it, don't spawn particles
+    // Check if UI consumed the click first; saving reads the world, so
+    // the simulation thread is held between ticks meanwhile
+    if (ui) {
+        std::unique_lock<std::mutex> worldLock;
+        if (simulation) {
+            worldLock = simulation->lockWorld();
+        }
+        if (ui->handleClick(worldPos)) {
+            return; // UI handled it, don't spawn particles
+        }
     }
     
     // Check if mouse is over UI area (prevent spawning when over UI)
@@ -283,83 +409,51 @@ bool SandSimApp::isMouseOverUI(const sf::Vector2f& worldPos) {
 }
 
 void SandSimApp::addParticles(const sf::Vector2f& worldPos) {
-    if (!world || !ui) return;
-    
-    int x = static_cast<int>(worldPos.x);
-    int y = static_cast<int>(worldPos.y);
-    
-    if (x >= 0 && x < TEXTURE_WIDTH && y >= 0 && y < TEXTURE_HEIGHT) {
-        world->addParticleCircle(x, y, ui->getSelectionRadius(), ui->getCurrentMaterialID());
-    }
+    addParticlesLine(worldPos, worldPos);
 }
 
 void SandSimApp::eraseParticles(const sf::Vector2f& worldPos) {
-    if (!world || !ui) return;
-    
-    int x = static_cast<int>(worldPos.x);
-    int y = static_cast<int>(worldPos.y);
-    
-    if (x >= 0 && x < TEXTURE_WIDTH && y >= 0 && y < TEXTURE_HEIGHT) {
-        world->eraseCircle(x, y, ui->getSelectionRadius());
-    }
+    eraseParticlesLine(worldPos, worldPos);
 }
 
 void SandSimApp::addParticlesLine(const sf::Vector2f& startPos, const sf::Vector2f& endPos) {
-    if (!ui) return;
+    if (!world || !ui) return;
     
-    // Calculate the distance between start and end positions
-    float dx = endPos.x - startPos.x;
-    float dy = endPos.y - startPos.y;
-    float distance = std::sqrt(dx * dx + dy * dy);
+    // The whole drag segment is one stroke, so no cell is tested twice
+    sf::Vector2i from(static_cast<int>(startPos.x), static_cast<int>(startPos.y));
+    sf::Vector2i to(static_cast<int>(endPos.x), static_cast<int>(endPos.y));
     
-    // If the distance is very small, just add particles at the current position
-    if (distance < 1.0f) {
-        addParticles(endPos);
+    if (simulation) {
+        // Map cells; the simulation thread places them in its current window
+        SimCommand command{SimCommand::Type::Brush, from.x + camera.x, from.y + camera.y, to.x + camera.x, to.y + camera.y,
+                           ui->getSelectionRadius(), ui->getCurrentMaterialID()};
+        simulation->post(command);
         return;
     }
     
-    // Calculate the number of steps based on the distance and brush radius
-    float stepSize = std::max(1.0f, ui->getSelectionRadius() * 0.5f);
-    int steps = static_cast<int>(std::ceil(distance / stepSize));
-    
-    // Draw particles along the line
-    for (int i = 0; i <= steps; ++i) {
-        float t = (steps > 0) ? static_cast<float>(i) / static_cast<float>(steps) : 0.0f;
-        sf::Vector2f currentPos(
-            startPos.x + t * dx,
-            startPos.y + t * dy
-        );
-        addParticles(currentPos);
-    }
+    from += getViewOffset();
+    to += getViewOffset();
+    world->addParticleStroke(from.x, from.y, to.x, to.y, ui->getSelectionRadius(), ui->getCurrentMaterialID());
+    recordCommand(ReplayCommandType::Stroke, from.x, from.y, to.x, to.y, ui->getSelectionRadius(), ui->getCurrentMaterialID());
 }
 
 void SandSimApp::eraseParticlesLine(const sf::Vector2f& startPos, const sf::Vector2f& endPos) {
-    if (!ui) return;
+    if (!world || !ui) return;
     
-    // Calculate the distance between start and end positions
-    float dx = endPos.x - startPos.x;
-    float dy = endPos.y - startPos.y;
-    float distance = std::sqrt(dx * dx + dy * dy);
+    sf::Vector2i from(static_cast<int>(startPos.x), static_cast<int>(startPos.y));
+    sf::Vector2i to(static_cast<int>(endPos.x), static_cast<int>(endPos.y));
     
-    // If the distance is very small, just erase particles at the current position
-    if (distance < 1.0f) {
-        eraseParticles(endPos);
+    if (simulation) {
+        SimCommand command{SimCommand::Type::Erase, from.x + camera.x, from.y + camera.y, to.x + camera.x, to.y + camera.y,
+                           ui->getSelectionRadius()};
+        simulation->post(command);
         return;
     }
     
-    // Calculate the number of steps based on the distance and brush radius
-    float stepSize = std::max(1.0f, ui->getSelectionRadius() * 0.5f);
-    int steps = static_cast<int>(std::ceil(distance / stepSize));
-    
-    // Erase particles along the line
-    for (int i = 0; i <= steps; ++i) {
-        float t = (steps > 0) ? static_cast<float>(i) / static_cast<float>(steps) : 0.0f;
-        sf::Vector2f currentPos(
-            startPos.x + t * dx,
-            startPos.y + t * dy
-        );
-        eraseParticles(currentPos);
-    }
+    from += getViewOffset();
+    to += getViewOffset();
+    world->eraseStroke(from.x, from.y, to.x, to.y, ui->getSelectionRadius());
+    recordCommand(ReplayCommandType::EraseStroke, from.x, from.y, to.x, to.y, ui->getSelectionRadius());
 }
 
 void SandSimApp::update() {
@@ -369,9 +463,18 @@ void SandSimApp::update() {
         // Measure frame time
         frameTime = static_cast<float>(frameClock.restart().asMilliseconds());
         
-        // Update simulation
-        if (simulationRunning && world) {
-            world->update(deltaTime.asSeconds());
+        // Update simulation in whole fixed ticks, so physics doesn't depend on
+        // the frame rate; recordings store the step and replay exactly
+        if (simulationRunning && world && !simulation) {
+            int ticks = timestep.advance(deltaTime.asSeconds());
+            for (int i = 0; i < ticks; ++i) {
+                world->update(timestep.getStep());
+                if (recording) {
+                    recording->frameHashes.push_back(world->computeHash());
+                }
+            }
+        } else {
+            timestep.reset();
         }
         
         // Update UI
@@ -384,6 +487,30 @@ void SandSimApp::update() {
     // Menu doesn't need update in the main loop - it's handled in events
 }
 
+void SandSimApp::recordCommand(ReplayCommandType type, int x, int y, int x2, int y2, float radius, MaterialID material) {
+    if (!recording) return;
+    
+    ReplayCommand command{};
+    command.type = type;
+    command.frame = recording->getFrameCount();
+    command.x = static_cast<std::int32_t>(x);
+    command.y = static_cast<std::int32_t>(y);
+    command.x2 = static_cast<std::int32_t>(x2);
+    command.y2 = static_cast<std::int32_t>(y2);
+    command.radius = radius;
+    command.material = material;
+    command.workers = static_cast<uint8_t>(std::min(workerCount, 255u));
+    recording->addCommand(command);
+}
+
+void SandSimApp::finishRecording() {
+    if (!recording) return;
+    
+    // One log per played level; a later level overwrites it
+    recording->save(recordPath);
+    recording.reset();
+}
+
 void SandSimApp::render() {
     // Clear window
     window.clear(sf::Color(20, 20, 20));
@@ -393,8 +520,12 @@ void SandSimApp::render() {
         levelMenu->render(window);
     } else if (currentState == GameState::PLAYING) {
         // Render game
-        if (world && renderer) {
-            renderer->render(window, *world);
+        if (simulation && renderer) {
+            // Show the newest finished frame; the simulation may be mid-tick
+            simulation->consumeFrame();
+            renderer->render(window, simulation->getFrame(), getViewOffset());
+        } else if (world && renderer) {
+            renderer->render(window, *world, getViewOffset());
         }
         
         if (ui) {
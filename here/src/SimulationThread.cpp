@@ -0,0 +1,170 @@
+#include "SimulationThread.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace SandSim {
+
+namespace {
+    // Frame sequences are unique across sessions, so a renderer that outlives
+    // one simulation never mistakes a new frame for one it already uploaded
+    std::atomic<std::uint64_t> nextFrameSequence{1};
+}
+
+SimulationThread::SimulationThread(ParticleWorld& world, int tickRate, ReplayLog* recording)
+    : world(world), recording(recording), timestep(tickRate), ticking(true), stopping(false)
+{
+    // The renderer starts from a complete frame rather than waiting a tick
+    publishFrame();
+    thread = std::thread(&SimulationThread::loop, this);
+}
+
+SimulationThread::~SimulationThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    thread.join();
+}
+
+void SimulationThread::post(const SimCommand& command)
+{
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        pendingCommands.push_back(command);
+    }
+    wakeCondition.notify_one();
+}
+
+void SimulationThread::loop()
+{
+    // Random state is per thread; a recording replays from its own seed
+    if (recording) {
+        Random::setSeed(recording->seed);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto lastWake = Clock::now();
+
+    std::unique_lock<std::mutex> lock(commandMutex);
+    while (true) {
+        // Sleep until the next tick; while paused, commands are applied as they arrive
+        auto nextTick = lastWake + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<float>(timestep.untilNextTick()));
+        wakeCondition.wait_until(lock, nextTick, [this] {
+            return stopping || (!ticking.load(std::memory_order_relaxed) && !pendingCommands.empty());
+        });
+        if (stopping) {
+            return;
+        }
+        activeCommands.swap(pendingCommands);
+        lock.unlock();
+
+        auto now = Clock::now();
+        float elapsed = std::chrono::duration<float>(now - lastWake).count();
+        lastWake = now;
+        int ticks = 0;
+        if (ticking.load(std::memory_order_relaxed)) {
+            ticks = timestep.advance(elapsed);
+        } else {
+            timestep.reset();
+        }
+
+        {
+            std::lock_guard<std::mutex> worldLock(worldMutex);
+            for (const auto& command : activeCommands) {
+                apply(command);
+            }
+
+            for (int i = 0; i < ticks; ++i) {
+                world.update(timestep.getStep());
+                if (recording) {
+                    recording->frameHashes.push_back(world.computeHash());
+                }
+            }
+
+            if (ticks > 0 || !activeCommands.empty()) {
+                publishFrame();
+            }
+        }
+        activeCommands.clear();
+
+        lock.lock();
+    }
+}
+
+void SimulationThread::apply(const SimCommand& command)
+{
+    // Commands are in map cells; a streamed world holds only a window of the map
+    int x = command.x - world.getOriginX();
+    int y = command.y - world.getOriginY();
+    int x2 = command.x2 - world.getOriginX();
+    int y2 = command.y2 - world.getOriginY();
+
+    ReplayCommand recorded{};
+    recorded.x = static_cast<std::int32_t>(x);
+    recorded.y = static_cast<std::int32_t>(y);
+    recorded.x2 = static_cast<std::int32_t>(x2);
+    recorded.y2 = static_cast<std::int32_t>(y2);
+    recorded.radius = command.radius;
+    recorded.material = command.material;
+    recorded.workers = static_cast<std::uint8_t>(std::min(command.workers, 255u));
+
+    switch (command.type) {
+        case SimCommand::Type::Brush:
+            world.addParticleStroke(x, y, x2, y2, command.radius, command.material);
+            recorded.type = ReplayCommandType::Stroke;
+            break;
+        case SimCommand::Type::Erase:
+            world.eraseStroke(x, y, x2, y2, command.radius);
+            recorded.type = ReplayCommandType::EraseStroke;
+            break;
+        case SimCommand::Type::Clear:
+            world.clear();
+            recorded.type = ReplayCommandType::Clear;
+            break;
+        case SimCommand::Type::SetWorkers:
+            world.setWorkerCount(command.workers);
+            recorded.type = ReplayCommandType::SetWorkers;
+            break;
+        case SimCommand::Type::FollowView:
+            world.followView(command.x, command.y, TEXTURE_WIDTH, TEXTURE_HEIGHT);
+            return;
+    }
+
+    if (recording) {
+        recorded.frame = recording->getFrameCount();
+        recording->addCommand(recorded);
+    }
+}
+
+void SimulationThread::publishFrame()
+{
+    WorldFrame& frame = frames.back();
+
+    // Rects cover only the changes since the previous published frame; a
+    // renderer that missed that frame uploads everything instead
+    bool partial = world.takeDirtyPixelRects(tickRects);
+    frame.fullyDirty = !partial || frame.width != world.getWidth() || frame.height != world.getHeight() ||
+                       tickRects.size() > MAX_FRAME_RECTS;
+    frame.dirtyRects.clear();
+    if (!frame.fullyDirty) {
+        frame.dirtyRects = tickRects;
+    }
+
+    std::size_t cellCount = static_cast<std::size_t>(world.getWidth()) * world.getHeight();
+    frame.previousSequence = publishedSequence;
+    frame.sequence = nextFrameSequence.fetch_add(1, std::memory_order_relaxed);
+    publishedSequence = frame.sequence;
+    frame.width = world.getWidth();
+    frame.height = world.getHeight();
+    frame.originX = world.getOriginX();
+    frame.originY = world.getOriginY();
+    frame.materials.assign(world.getMaterialBuffer(), world.getMaterialBuffer() + cellCount);
+    frame.variations.assign(world.getVariationBuffer(), world.getVariationBuffer() + cellCount);
+
+    frames.publish();
+}
+
+} // namespace SandSim
@@ -0,0 +1,142 @@
+#include "ThumbnailCache.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace SandSim {
+
+namespace {
+    const char CACHE_MAGIC[4] = {'R', 'R', 'T', 'C'};
+    const std::uint32_t CACHE_VERSION = 1;
+    // Anything longer is a damaged cache, not a real path
+    const std::uint32_t MAX_PATH_LENGTH = 4096;
+
+    template <typename T>
+    void writeValue(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    bool readValue(std::ifstream& file, T& value) {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+}
+
+ThumbnailCache::ThumbnailCache(const std::string& cacheFile) : cacheFile(cacheFile) {
+    load();
+}
+
+const WorldThumbnail* ThumbnailCache::get(const std::string& worldFile) {
+    std::error_code error;
+    std::int64_t modified = std::filesystem::last_write_time(worldFile, error).time_since_epoch().count();
+    std::uint64_t size = error ? 0 : std::filesystem::file_size(worldFile, error);
+    if (error) {
+        return nullptr;
+    }
+
+    Entry& entry = entries[worldFile];
+    if (entry.thumbnail.pixels.empty() || entry.modified != modified || entry.size != size) {
+        entry.modified = modified;
+        entry.size = size;
+        changed = true;
+        if (!WorldFile::readThumbnail(worldFile, entry.thumbnail)) {
+            entries.erase(worldFile);
+            return nullptr;
+        }
+    }
+
+    entry.used = true;
+    return &entry.thumbnail;
+}
+
+void ThumbnailCache::flush() {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (!it->second.used) {
+            it = entries.erase(it);
+            changed = true;
+        } else {
+            it->second.used = false;
+            ++it;
+        }
+    }
+
+    if (changed && save()) {
+        changed = false;
+    }
+}
+
+void ThumbnailCache::load() {
+    std::ifstream file(cacheFile, std::ios::binary);
+    if (!file.is_open()) {
+        return;
+    }
+
+    char magic[4];
+    std::uint32_t version = 0;
+    std::uint32_t count = 0;
+    if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, CACHE_MAGIC) ||
+        !readValue(file, version) || version != CACHE_VERSION || !readValue(file, count)) {
+        return;
+    }
+
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::uint32_t pathLength = 0;
+        std::uint16_t width = 0, height = 0;
+        Entry entry;
+        if (!readValue(file, pathLength)) break;
+        if (pathLength > MAX_PATH_LENGTH) {
+            std::cerr << "Corrupt thumbnail cache: " << cacheFile << std::endl;
+            break;
+        }
+        std::string path(pathLength, '\0');
+        file.read(&path[0], pathLength);
+        readValue(file, entry.modified);
+        readValue(file, entry.size);
+        readValue(file, width);
+        readValue(file, height);
+        // Thumbnails are never written larger than this
+        if (width > WorldFile::THUMBNAIL_MAX_SIZE || height > WorldFile::THUMBNAIL_MAX_SIZE) {
+            std::cerr << "Corrupt thumbnail cache: " << cacheFile << std::endl;
+            break;
+        }
+        entry.thumbnail.width = width;
+        entry.thumbnail.height = height;
+        entry.thumbnail.pixels.resize(static_cast<std::size_t>(width) * height * 4);
+        file.read(reinterpret_cast<char*>(entry.thumbnail.pixels.data()), entry.thumbnail.pixels.size());
+        if (!file) {
+            std::cerr << "Truncated thumbnail cache: " << cacheFile << std::endl;
+            break;
+        }
+        entries[path] = std::move(entry);
+    }
+}
+
+bool ThumbnailCache::save() const {
+    std::ofstream file(cacheFile, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open thumbnail cache for writing: " << cacheFile << std::endl;
+        return false;
+    }
+
+    file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    writeValue(file, CACHE_VERSION);
+    writeValue(file, static_cast<std::uint32_t>(entries.size()));
+    for (const auto& [path, entry] : entries) {
+        writeValue(file, static_cast<std::uint32_t>(path.size()));
+        file.write(path.data(), path.size());
+        writeValue(file, entry.modified);
+        writeValue(file, entry.size);
+        writeValue(file, static_cast<std::uint16_t>(entry.thumbnail.width));
+        writeValue(file, static_cast<std::uint16_t>(entry.thumbnail.height));
+        file.write(reinterpret_cast<const char*>(entry.thumbnail.pixels.data()), entry.thumbnail.pixels.size());
+    }
+
+    if (!file) {
+        std::cerr << "Error writing thumbnail cache: " << cacheFile << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace SandSim
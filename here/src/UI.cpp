@@ -47,7 +47,7 @@ UI::UI(ParticleWorld* worldPtr) : currentSelection(MaterialSelection::Sand),
         
         std::string controls = 
             "Controls:\n"
-            "B - Bloom\n"
+            "B - Bloom | T - Threads | P - Palette\n"
             "I - Toggle UI | F - Toggle FPS\n";
         controlsText.setString(controls);
 
@@ -109,8 +109,19 @@ bool UI::handleClick(const sf::Vector2f& worldMousePos) {
     if (isPointInRect(worldMousePos, saveButton.position, saveButton.size)) {
         if (world != nullptr) {
             saveButton.isPressed = true;
-            world->saveWorld("world");  // Call save method
-            std::cout << "Save button clicked!" << std::endl;
+            // Streamed maps already live on disk; only the resident chunks need
+            // writing back, which the saver thread does from copies
+            if (world->isStreaming()) {
+                if (!saver.saveChunks(world->getChunkStore(), world->snapshotChunks())) {
+                    std::cout << "Save already in progress" << std::endl;
+                }
+                return true;
+            }
+            // Copy the grid between frames; encoding and writing happen on the saver thread
+            std::string filename = world->getNextAvailableFilename("worlds/world");
+            if (!saver.save(world->snapshot(), filename)) {
+                std::cout << "Save already in progress" << std::endl;
+            }
         } else {
             std::cerr << "Warning: World reference not set in UI!" << std::endl;
         }
@@ -199,6 +210,8 @@ void UI::update(const sf::Vector2f& worldMousePos, float frameTime, bool simulat
         }
     }
 
+    updateSaveStatus();
+
     // Update frame info text content
     if (showFrameCount && fontLoaded) {
         std::string fpsText = "FPS: " + std::to_string(static_cast<int>(1000.0f / std::max(frameTime, 1.0f)));
@@ -211,6 +224,38 @@ void UI::update(const sf::Vector2f& worldMousePos, float frameTime, bool simulat
         simulationStateText.setString(simulationRunning ? "Simulation: Running" : "Simulation: Paused");
     }
 }
+void UI::updateSaveStatus() {
+    std::string filename;
+    switch (saver.poll(filename)) {
+        case WorldSaver::Status::Saving:
+            setSaveButtonText("Saving...");
+            break;
+        case WorldSaver::Status::Saved:
+            std::cout << "World saved successfully as: " << filename << std::endl;
+            setSaveButtonText("Saved!");
+            saveStatusClock.restart();
+            break;
+        case WorldSaver::Status::Failed:
+            std::cerr << "Failed to save world: " << filename << std::endl;
+            setSaveButtonText("Save Failed");
+            saveStatusClock.restart();
+            break;
+        case WorldSaver::Status::Idle:
+            // Keep the result visible for a moment before going back to the label
+            if (saveStatusClock.getElapsedTime().asSeconds() > 2.0f) {
+                setSaveButtonText(SaveButton().text);
+            }
+            break;
+    }
+}
+
+void UI::setSaveButtonText(const std::string& text) {
+    if (saveButton.text != text) {
+        saveButton.text = text;
+        setupSaveButton();
+    }
+}
+
 void UI::drawSaveButton() {
     sf::RectangleShape buttonRect;
     buttonRect.setPosition(sf::Vector2f(static_cast<float>(saveButton.position.x), 
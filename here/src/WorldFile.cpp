@@ -0,0 +1,400 @@
+#include "WorldFile.hpp"
+#include "Materials.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace SandSim {
+
+namespace {
+    const char WORLD_MAGIC[4] = {'R', 'R', 'R', '2'};
+    const std::size_t V1_CELL_SIZE = 17;
+    const std::size_t V2_HEADER_SIZE = 20;
+    // Largest world a file may declare (a 4096x4096 map); anything bigger is
+    // treated as corrupt rather than allocated
+    const std::size_t MAX_FILE_CELLS = std::size_t(1) << 24;
+
+    enum RecordField : std::uint8_t {
+        FIELD_VELOCITY = 1,
+        FIELD_LIFETIME = 2
+    };
+
+    class Writer {
+    public:
+        explicit Writer(std::vector<char>& out) : out(out) {}
+
+        template <typename T>
+        void value(const T& v) {
+            const char* bytes = reinterpret_cast<const char*>(&v);
+            out.insert(out.end(), bytes, bytes + sizeof(v));
+        }
+
+        void varint(std::uint32_t v) {
+            while (v >= 0x80) {
+                out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+                v >>= 7;
+            }
+            out.push_back(static_cast<char>(v));
+        }
+
+    private:
+        std::vector<char>& out;
+    };
+
+    // Bounds-checked cursor; every read fails once the data runs out
+    class Reader {
+    public:
+        explicit Reader(const std::vector<char>& data) : data(data) {}
+
+        template <typename T>
+        bool value(T& v) {
+            if (data.size() - pos < sizeof(v)) return false;
+            std::memcpy(&v, data.data() + pos, sizeof(v));
+            pos += sizeof(v);
+            return true;
+        }
+
+        bool varint(std::uint32_t& v) {
+            v = 0;
+            for (int shift = 0; shift < 35; shift += 7) {
+                if (pos >= data.size()) return false;
+                std::uint8_t byte = static_cast<std::uint8_t>(data[pos++]);
+                v |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return true;
+            }
+            return false;
+        }
+
+        std::size_t remaining() const { return data.size() - pos; }
+        void skip(std::size_t count) { pos += std::min(count, remaining()); }
+
+    private:
+        const std::vector<char>& data;
+        std::size_t pos = 0;
+    };
+
+    bool validMaterial(std::uint8_t id) {
+        return id < MATERIAL_COUNT;
+    }
+
+    void resizePlanes(WorldSnapshot& snapshot, std::size_t cellCount) {
+        snapshot.materials.assign(cellCount, MaterialID::Empty);
+        snapshot.variations.assign(cellCount, 0);
+        snapshot.velocities.assign(cellCount, sf::Vector2f(0.0f, 0.0f));
+        snapshot.lifeTimes.assign(cellCount, 0.0f);
+        snapshot.colors.clear();
+    }
+
+    // Closest variation for a colour stored by a v1 file. Palette and fade
+    // colours map back exactly; jittered ones get a variation derived from
+    // the colour, which keeps the per-cell grain without matching it exactly.
+    std::uint8_t variationForColor(MaterialID id, sf::Color color) {
+        const MaterialProps& props = getMaterial(id);
+        switch (props.colorMode) {
+            case ColorMode::Jitter:
+                return static_cast<std::uint8_t>(color.r * 7 + color.g * 3 + color.b);
+            case ColorMode::Palette: {
+                int best = 0;
+                int bestDistance = INT_MAX;
+                for (int i = 0; i < props.paletteSize; ++i) {
+                    const sf::Color& entry = props.palette[i];
+                    int distance = std::abs(entry.r - color.r) + std::abs(entry.g - color.g) + std::abs(entry.b - color.b);
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        best = i;
+                    }
+                }
+                return static_cast<std::uint8_t>(best);
+            }
+            case ColorMode::Fade:
+            case ColorMode::FadeAlpha:
+                if (props.baseColor.a == 0) return 255;
+                return static_cast<std::uint8_t>(std::min(255, color.a * 255 / props.baseColor.a));
+        }
+        return 0;
+    }
+
+    bool decodeV1(Reader& in, WorldSnapshot& snapshot) {
+        std::size_t cellCount = static_cast<std::size_t>(snapshot.width) * snapshot.height;
+        if (in.remaining() < cellCount * V1_CELL_SIZE) return false;
+
+        resizePlanes(snapshot, cellCount);
+        snapshot.colors.assign(cellCount, MAT_COL_EMPTY);
+        for (std::size_t i = 0; i < cellCount; ++i) {
+            std::uint8_t id = 0;
+            in.value(id);
+            in.value(snapshot.velocities[i].x);
+            in.value(snapshot.velocities[i].y);
+            in.value(snapshot.lifeTimes[i]);
+            in.value(snapshot.colors[i].r);
+            in.value(snapshot.colors[i].g);
+            in.value(snapshot.colors[i].b);
+            in.value(snapshot.colors[i].a);
+            if (!validMaterial(id)) return false;
+            snapshot.materials[i] = static_cast<MaterialID>(id);
+            snapshot.variations[i] = variationForColor(snapshot.materials[i], snapshot.colors[i]);
+        }
+        return true;
+    }
+
+    bool decodeV2(Reader& in, WorldSnapshot& snapshot) {
+        std::size_t cellCount = static_cast<std::size_t>(snapshot.width) * snapshot.height;
+        resizePlanes(snapshot, cellCount);
+
+        // Material runs
+        std::size_t cell = 0;
+        std::size_t filled = 0;
+        while (cell < cellCount) {
+            std::uint8_t id = 0;
+            std::uint32_t length = 0;
+            if (!in.value(id) || !in.varint(length) || !validMaterial(id) ||
+                length == 0 || length > cellCount - cell) {
+                return false;
+            }
+            std::fill_n(snapshot.materials.begin() + cell, length, static_cast<MaterialID>(id));
+            if (id != static_cast<std::uint8_t>(MaterialID::Empty)) filled += length;
+            cell += length;
+        }
+
+        // Variations of the non-empty cells, in cell order
+        if (in.remaining() < filled) return false;
+        for (std::size_t i = 0; i < cellCount; ++i) {
+            if (snapshot.materials[i] != MaterialID::Empty) {
+                in.value(snapshot.variations[i]);
+            }
+        }
+
+        // Sparse velocity / lifetime records
+        std::uint32_t recordCount = 0;
+        if (!in.varint(recordCount)) return false;
+        std::size_t index = 0;
+        for (std::uint32_t r = 0; r < recordCount; ++r) {
+            std::uint32_t delta = 0;
+            std::uint8_t fields = 0;
+            if (!in.varint(delta) || !in.value(fields)) return false;
+            index += delta;
+            if (index >= cellCount) return false;
+            if ((fields & FIELD_VELOCITY) && !in.value(snapshot.velocities[index])) return false;
+            if ((fields & FIELD_LIFETIME) && !in.value(snapshot.lifeTimes[index])) return false;
+        }
+        return true;
+    }
+}
+
+namespace WorldFile {
+
+std::vector<char> encode(const WorldSnapshot& snapshot, bool withThumbnail) {
+    const std::size_t cellCount = snapshot.materials.size();
+    std::vector<char> out;
+    out.reserve(32 + cellCount / 4);
+    Writer w(out);
+
+    out.insert(out.end(), WORLD_MAGIC, WORLD_MAGIC + sizeof(WORLD_MAGIC));
+    w.value(VERSION);
+    w.value(withThumbnail ? FLAG_THUMBNAIL : std::uint16_t(0));
+    w.value(snapshot.width);
+    w.value(snapshot.height);
+    w.value(snapshot.frameCounter);
+
+    if (withThumbnail) {
+        WorldThumbnail thumbnail = makeThumbnail(snapshot);
+        w.value(static_cast<std::uint16_t>(thumbnail.width));
+        w.value(static_cast<std::uint16_t>(thumbnail.height));
+        out.insert(out.end(), thumbnail.pixels.begin(), thumbnail.pixels.end());
+    }
+
+    // Material runs
+    for (std::size_t i = 0; i < cellCount;) {
+        std::size_t end = i + 1;
+        while (end < cellCount && snapshot.materials[end] == snapshot.materials[i]) ++end;
+        w.value(static_cast<std::uint8_t>(snapshot.materials[i]));
+        w.varint(static_cast<std::uint32_t>(end - i));
+        i = end;
+    }
+
+    for (std::size_t i = 0; i < cellCount; ++i) {
+        if (snapshot.materials[i] != MaterialID::Empty) {
+            w.value(snapshot.variations[i]);
+        }
+    }
+
+    // Records only for cells whose velocity or lifetime is not the default
+    std::uint32_t recordCount = 0;
+    for (std::size_t i = 0; i < cellCount; ++i) {
+        const sf::Vector2f& v = snapshot.velocities[i];
+        if (v.x != 0.0f || v.y != 0.0f || snapshot.lifeTimes[i] != 0.0f) ++recordCount;
+    }
+    w.varint(recordCount);
+
+    std::size_t previous = 0;
+    for (std::size_t i = 0; i < cellCount; ++i) {
+        const sf::Vector2f& v = snapshot.velocities[i];
+        std::uint8_t fields = 0;
+        if (v.x != 0.0f || v.y != 0.0f) fields |= FIELD_VELOCITY;
+        if (snapshot.lifeTimes[i] != 0.0f) fields |= FIELD_LIFETIME;
+        if (!fields) continue;
+
+        w.varint(static_cast<std::uint32_t>(i - previous));
+        w.value(fields);
+        if (fields & FIELD_VELOCITY) w.value(v);
+        if (fields & FIELD_LIFETIME) w.value(snapshot.lifeTimes[i]);
+        previous = i;
+    }
+
+    return out;
+}
+
+bool decode(const std::vector<char>& data, WorldSnapshot& snapshot) {
+    Reader in(data);
+
+    // v1 files have no magic and start straight with the dimensions
+    bool isV2 = data.size() >= sizeof(WORLD_MAGIC) &&
+                std::equal(WORLD_MAGIC, WORLD_MAGIC + sizeof(WORLD_MAGIC), data.begin());
+    std::uint16_t version = 1;
+    std::uint16_t flags = 0;
+    if (isV2) {
+        char magic[4];
+        in.value(magic);
+        if (!in.value(version) || !in.value(flags) || version != VERSION) {
+            std::cerr << "Unsupported world file version: " << version << std::endl;
+            return false;
+        }
+    }
+
+    if (!in.value(snapshot.width) || !in.value(snapshot.height) || !in.value(snapshot.frameCounter) ||
+        snapshot.width <= 0 || snapshot.height <= 0 ||
+        static_cast<std::size_t>(snapshot.width) * snapshot.height > MAX_FILE_CELLS) {
+        return false;
+    }
+
+    if (flags & FLAG_THUMBNAIL) {
+        std::uint16_t thumbWidth = 0, thumbHeight = 0;
+        if (!in.value(thumbWidth) || !in.value(thumbHeight)) return false;
+        in.skip(static_cast<std::size_t>(thumbWidth) * thumbHeight * 4);
+    }
+
+    return isV2 ? decodeV2(in, snapshot) : decodeV1(in, snapshot);
+}
+
+bool write(const std::string& filename, const WorldSnapshot& snapshot, bool withThumbnail) {
+    std::vector<char> data = encode(snapshot, withThumbnail);
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file for writing: " << filename << std::endl;
+        return false;
+    }
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+        std::cerr << "Error saving world: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool read(const std::string& filename, WorldSnapshot& snapshot) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file for reading: " << filename << std::endl;
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    std::vector<char> data(size > 0 ? static_cast<std::size_t>(size) : 0);
+    file.seekg(0);
+    if (!file.read(data.data(), size)) {
+        std::cerr << "Error reading world file: " << filename << std::endl;
+        return false;
+    }
+
+    if (!decode(data, snapshot)) {
+        std::cerr << "Corrupt world file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+WorldThumbnail makeThumbnail(const WorldSnapshot& snapshot) {
+    WorldThumbnail thumbnail;
+    const int scale = std::max({THUMBNAIL_SCALE,
+                                (snapshot.width + THUMBNAIL_MAX_SIZE - 1) / THUMBNAIL_MAX_SIZE,
+                                (snapshot.height + THUMBNAIL_MAX_SIZE - 1) / THUMBNAIL_MAX_SIZE});
+    thumbnail.width = (snapshot.width + scale - 1) / scale;
+    thumbnail.height = (snapshot.height + scale - 1) / scale;
+    thumbnail.pixels.assign(thumbnail.width * thumbnail.height * 4, 0);
+
+    const bool storedColors = !snapshot.colors.empty();
+    for (unsigned int ty = 0; ty < thumbnail.height; ++ty) {
+        for (unsigned int tx = 0; tx < thumbnail.width; ++tx) {
+            // Average the filled cells of the block; mostly empty blocks stay transparent
+            unsigned int sum[3] = {0, 0, 0};
+            int filled = 0;
+            int total = 0;
+            for (int y = ty * scale; y < std::min<int>((ty + 1) * scale, snapshot.height); ++y) {
+                for (int x = tx * scale; x < std::min<int>((tx + 1) * scale, snapshot.width); ++x) {
+                    std::size_t i = static_cast<std::size_t>(y) * snapshot.width + x;
+                    ++total;
+                    if (snapshot.materials[i] == MaterialID::Empty) continue;
+                    sf::Color c = storedColors ? snapshot.colors[i] : materialColor(snapshot.materials[i], snapshot.variations[i]);
+                    sum[0] += c.r;
+                    sum[1] += c.g;
+                    sum[2] += c.b;
+                    ++filled;
+                }
+            }
+            if (filled == 0 || filled * 2 < total) continue;
+
+            std::uint8_t* pixel = &thumbnail.pixels[(ty * thumbnail.width + tx) * 4];
+            pixel[0] = static_cast<std::uint8_t>(sum[0] / filled);
+            pixel[1] = static_cast<std::uint8_t>(sum[1] / filled);
+            pixel[2] = static_cast<std::uint8_t>(sum[2] / filled);
+            pixel[3] = 255;
+        }
+    }
+    return thumbnail;
+}
+
+bool readThumbnail(const std::string& filename, WorldThumbnail& thumbnail) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file for reading: " << filename << std::endl;
+        return false;
+    }
+
+    // Fixed header plus the thumbnail dimensions
+    std::vector<char> header(V2_HEADER_SIZE + 4);
+    if (file.read(header.data(), static_cast<std::streamsize>(header.size()))) {
+        Reader in(header);
+        char magic[4];
+        std::uint16_t version = 0, flags = 0, thumbWidth = 0, thumbHeight = 0;
+        in.value(magic);
+        in.value(version);
+        in.value(flags);
+        in.skip(V2_HEADER_SIZE - 8);
+        in.value(thumbWidth);
+        in.value(thumbHeight);
+
+        // An oversized thumbnail was never written by us; decode the world instead
+        if (std::equal(magic, magic + 4, WORLD_MAGIC) && version == VERSION && (flags & FLAG_THUMBNAIL) &&
+            thumbWidth <= THUMBNAIL_MAX_SIZE && thumbHeight <= THUMBNAIL_MAX_SIZE) {
+            thumbnail.width = thumbWidth;
+            thumbnail.height = thumbHeight;
+            thumbnail.pixels.assign(static_cast<std::size_t>(thumbWidth) * thumbHeight * 4, 0);
+            return static_cast<bool>(file.read(reinterpret_cast<char*>(thumbnail.pixels.data()),
+                                               static_cast<std::streamsize>(thumbnail.pixels.size())));
+        }
+    }
+
+    file.close();
+    WorldSnapshot snapshot;
+    if (!read(filename, snapshot)) return false;
+    thumbnail = makeThumbnail(snapshot);
+    return true;
+}
+
+} // namespace WorldFile
+
+} // namespace SandSim
@@ -0,0 +1,103 @@
+#include "WorldSaver.hpp"
+
+namespace SandSim {
+
+WorldSaver::WorldSaver()
+    : pendingVersion(0), hasPending(false), writing(false), stopping(false), finished(Status::Idle)
+{
+    writer = std::thread(&WorldSaver::writerLoop, this);
+}
+
+WorldSaver::~WorldSaver()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    writer.join();
+}
+
+bool WorldSaver::save(WorldSnapshot snapshot, const std::string& filename)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (hasPending || writing) {
+            return false;
+        }
+        pending = std::move(snapshot);
+        pendingFilename = filename;
+        hasPending = true;
+        finished = Status::Idle;
+    }
+    wakeCondition.notify_one();
+    return true;
+}
+
+bool WorldSaver::saveChunks(std::shared_ptr<ChunkStore> store, std::vector<ChunkPage> pages)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (hasPending || writing) {
+            return false;
+        }
+        pendingVersion = store->reserveVersion();
+        pendingFilename = store->getDirectory();
+        pendingStore = std::move(store);
+        pendingPages = std::move(pages);
+        hasPending = true;
+        finished = Status::Idle;
+    }
+    wakeCondition.notify_one();
+    return true;
+}
+
+WorldSaver::Status WorldSaver::poll(std::string& filename)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (hasPending || writing) {
+        filename = hasPending ? pendingFilename : finishedFilename;
+        return Status::Saving;
+    }
+
+    Status result = finished;
+    filename = finishedFilename;
+    finished = Status::Idle;
+    return result;
+}
+
+void WorldSaver::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        // Drain the pending save even when stopping, so closing never loses one
+        wakeCondition.wait(lock, [this] { return hasPending || stopping; });
+        if (!hasPending) {
+            return;
+        }
+
+        WorldSnapshot snapshot = std::move(pending);
+        std::shared_ptr<ChunkStore> store = std::move(pendingStore);
+        std::vector<ChunkPage> pages = std::move(pendingPages);
+        std::uint64_t version = pendingVersion;
+        finishedFilename = pendingFilename;
+        hasPending = false;
+        writing = true;
+
+        lock.unlock();
+        bool ok = true;
+        if (store) {
+            for (const ChunkPage& page : pages) {
+                ok = store->write(page.cx, page.cy, page.cells, version) && ok;
+            }
+        } else {
+            ok = WorldFile::write(finishedFilename, snapshot);
+        }
+        lock.lock();
+
+        writing = false;
+        finished = ok ? Status::Saved : Status::Failed;
+    }
+}
+
+} // namespace SandSim
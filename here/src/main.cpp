@@ -1,10 +1,77 @@
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include "SandSim.hpp"
+#include "Replay.hpp"
+#include "Reactions.hpp"
 
-int main() {
+// Re-runs a recorded session headlessly and reports the first divergent frame
+static int replayFromFile(const std::string& path) {
+    SandSim::ReplayLog log;
+    if (!log.load(path)) {
+        return -1;
+    }
+    
+    std::cout << "Replaying " << path << ": " << log.getFrameCount() << " frames, "
+              << log.commands.size() << " commands, level '" << log.worldFile << "'" << std::endl;
+    
+    SandSim::ReplayResult result = SandSim::runReplay(log);
+    if (result.divergentFrame >= 0) {
+        std::cout << "Diverged at frame " << result.divergentFrame << std::hex
+                  << " (expected " << result.expectedHash << ", got " << result.actualHash << ")" << std::endl;
+        return 1;
+    }
+    
+    std::cout << "Replay matched all frames" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // --record <file>: log input and per-frame hashes while playing
+    // --replay <file>: re-run a log without opening a window
+    // --map <dir>: play a streamed map, paged to and from the directory
+    // --chunk-budget <n>: most chunks of a streamed map kept in memory
+    // --sim-thread: update the world on its own thread
+    // --tick-rate <hz>: fixed simulation updates per second
+    // --reactions <file>: pairwise reaction table to load instead of the default
+    std::string recordPath;
+    std::string replayPath;
+    std::string mapPath;
+    int chunkBudget = SandSim::DEFAULT_RESIDENT_CHUNK_BUDGET;
+    bool simulationThread = false;
+    int tickRate = SandSim::DEFAULT_TICK_RATE;
+    std::string reactionsPath = "assets/reactions.txt";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--record" && hasValue) {
+            recordPath = argv[++i];
+        } else if (arg == "--replay" && hasValue) {
+            replayPath = argv[++i];
+        } else if (arg == "--map" && hasValue) {
+            mapPath = argv[++i];
+        } else if (arg == "--chunk-budget" && hasValue) {
+            chunkBudget = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--tick-rate" && hasValue) {
+            tickRate = std::clamp(std::atoi(argv[++i]), 1, 1000);
+        } else if (arg == "--reactions" && hasValue) {
+            reactionsPath = argv[++i];
+        } else if (arg == "--sim-thread") {
+            simulationThread = true;
+        }
+    }
+    
+    // Falls back to the built-in reactions if the file can't be read
+    SandSim::ReactionTable::load(reactionsPath);
+    
     try {
-        SandSim::SandSimApp app;
+        if (!replayPath.empty()) {
+            return replayFromFile(replayPath);
+        }
+        
+        SandSim::SandSimApp app(recordPath, mapPath, chunkBudget, simulationThread, tickRate);
         app.run();
     }
     catch (const std::exception& e) {
@@ -17,4 +84,4 @@ int main() {
     }
     
     return 0;
-}
\ No newline at end of file
+}